@@ -0,0 +1,70 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "engine.h"
+#include "instances.h"
+#include "mkpproblem.h"
+#include "reference.h"
+#include "rng.h"
+#include "solution.h"
+
+#include <chrono>
+#include <iostream>
+
+using namespace std::chrono;
+
+/**
+ * Time the bit-parallel crossover against the per-item reference
+ */
+template<size_t W>
+static void throughput(const problem& p, const Solution<W>& a, const Solution<W>& b) {
+	const size_t repetitions = std::max<size_t>(1000, 2000000 / static_cast<size_t>(p.n));
+
+	unsigned int sink  = 0;
+	auto         begin = steady_clock::now();
+	for (size_t r = 0; r < repetitions; ++r) sink += crossover(a, b, p).hash() & 1;
+	auto bit_parallel = duration<double, std::nano>(steady_clock::now() - begin).count();
+
+	rng random(7);
+	begin = steady_clock::now();
+	for (size_t r = 0; r < repetitions; ++r) {
+		reference_child reference(a.items(), p);
+		reference.cross(a.items(), b.items(), p, random);
+		sink += reference.value & 1;
+	}
+	auto per_item = duration<double, std::nano>(steady_clock::now() - begin).count();
+
+	// The reference also pays for building the child from a, time that separately
+	begin = steady_clock::now();
+	for (size_t r = 0; r < repetitions; ++r) sink += reference_child(a.items(), p).value & 1;
+	auto copy = duration<double, std::nano>(steady_clock::now() - begin).count();
+
+	if (sink == UINT_MAX) std::cout << sink;
+	const auto reps = static_cast<double>(repetitions);
+	std::cout << "  bit-parallel: " << bit_parallel / reps
+	          << " ns, per item: " << (per_item - copy) / reps << " ns (excluding the copy)\n";
+}
+
+/**
+ * Microbenchmark of the crossover for n = 100, 250 and 10^4, tests/crossover_test.cpp checks its
+ * offspring distribution
+ * usage: mkp-crossover-bench
+ */
+int main() {
+	for (size_t n : { 100, 250, 10000 }) {
+		const problem* p = random_instance(n, 10).build();
+		with_width(*p, [&](auto width) {
+			constexpr size_t W = decltype(width)::value;
+			generator() = rng(1);
+			const Solution<W> a(*p, random_ch{});
+			const Solution<W> b(*p, random_ch{});
+
+			std::cout << "n = " << n << "\n";
+			throughput(*p, a, b);
+		});
+		delete p;
+	}
+
+	return 0;
+}
@@ -0,0 +1,93 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "engine.h"
+#include "mkpproblem.h"
+#include "reference.h"
+#include "rng.h"
+#include "solution.h"
+#include "util.h"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+using namespace std::chrono;
+
+/**
+ * Time a full construction and improvement run, every run starts from the same seed
+ * @return milliseconds per run and the solution of the last run
+ */
+template<size_t W, class CH, class II>
+static std::pair<double, Solution<W>> run(const problem& p, CH ch, II ii, size_t repetitions) {
+	Solution<W> last(p);
+	auto        begin = steady_clock::now();
+	for (size_t r = 0; r < repetitions; ++r) {
+		generator() = rng(r);
+		Solution<W> s(p, ch);
+		improve(s, p, ch, ii);
+		if (r + 1 == repetitions) last = s;
+	}
+	auto ms = duration<double, std::milli>(steady_clock::now() - begin).count();
+	return { ms / static_cast<double>(repetitions), last };
+}
+
+template<size_t W, class II>
+static void compare(const problem& p, const char* name, II ii, size_t repetitions) {
+	const std::pair<const char*, void (Solution<W>::*)(const problem&)> heuristics[] = {
+		{ "greedy", &Solution<W>::greedy },
+		{ "toyoda", &Solution<W>::toyoda },
+	};
+
+	for (const auto& [heuristic, pointer] : heuristics) {
+		// Alternate both dispatches a few times and keep the fastest to suppress noise
+		double indirect = INFINITY, tagged = INFINITY;
+		bool   match    = true;
+		for (size_t round = 0; round < 5; ++round) {
+			auto [indirect_ms, indirect_solution] = run<W>(p, opaque(pointer), ii, repetitions);
+			auto [tagged_ms, tagged_solution]     = pointer == &Solution<W>::greedy
+			                                            ? run<W>(p, greedy_ch{}, ii, repetitions)
+			                                            : run<W>(p, toyoda_ch{}, ii, repetitions);
+			indirect = std::min(indirect, indirect_ms);
+			tagged   = std::min(tagged, tagged_ms);
+			match &= indirect_solution == tagged_solution;
+		}
+		std::cout << "  " << heuristic << " + " << name << ": member pointer " << indirect
+		          << " ms, tag " << tagged << " ms (" << indirect / tagged << "x)"
+		          << (match ? "" : " MISMATCH") << "\n";
+	}
+}
+
+/**
+ * Compare the static tag dispatch with member function pointer dispatch of the constructive
+ * heuristic inside the iterative improvement algorithms
+ * usage: mkp-engine-bench repetitions instance...
+ */
+int main(int argc, char* argv[]) {
+	if (argc < 3) {
+		std::cerr << "usage: " << argv[0] << " repetitions instance..." << std::endl;
+		return 1;
+	}
+	const size_t repetitions = std::stoul(argv[1]);
+
+	for (int i = 2; i < argc; ++i) {
+		std::string    error;
+		const problem* p = read_problem(argv[i], &error);
+		if (!p) {
+			std::cerr << error << std::endl;
+			return 1;
+		}
+		std::cout << argv[i] << " (n = " << p->n << ", m = " << p->m << ")\n";
+		with_width(*p, [&](auto width) {
+			constexpr size_t W = decltype(width)::value;
+			compare<W>(*p, "FI", first_improvement_ii{}, repetitions);
+			compare<W>(*p, "BI", best_improvement_ii{}, repetitions);
+			compare<W>(*p, "VND", vnd_ii{}, repetitions);
+		});
+		delete p;
+	}
+
+	return 0;
+}
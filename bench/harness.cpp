@@ -0,0 +1,354 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "solver.h"
+#include "util.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <thread>
+
+using namespace std::chrono;
+
+struct instance {
+	std::string    name;
+	const problem* p;
+	unsigned int   best;
+};
+
+struct algorithm {
+	// The command line flags of MKP that select it
+	std::string name;
+	options     o;
+};
+
+/**
+ * A run of the grid and its outcome
+ */
+struct run {
+	size_t algorithm;
+	double fraction;
+	size_t instance;
+	int    seed;
+
+	// Whether the solve ran, a run that did not is left out of the results
+	bool         solved = false;
+	unsigned int value  = 0;
+	statistics   stats;
+	// The improvements of the best value, in order of time
+	std::vector<incumbent> trace;
+};
+
+/**
+ * @param s
+ * @param delimiter
+ * @return the non-empty parts of s
+ */
+static std::vector<std::string> split(const std::string& s, char delimiter) {
+	std::vector<std::string> parts;
+	std::istringstream       stream(s);
+	for (std::string part; std::getline(stream, part, delimiter);)
+		if (!part.empty()) parts.push_back(part);
+	return parts;
+}
+
+/**
+ * Parse the options of an algorithm from MKP command line flags, e.g. "--SA --tempering"
+ * @param flags
+ * @return
+ */
+static algorithm parse_algorithm(const std::string& flags) {
+	std::vector<std::string> words{ "mkp-bench", "" };
+	std::istringstream       stream(flags);
+	for (std::string word; stream >> word;) words.push_back(word);
+
+	std::vector<char*> argv;
+	for (auto& word : words) argv.push_back(word.data());
+	params* pars = read_params(static_cast<int>(argv.size()), argv.data());
+
+	algorithm a{ flags, *pars };
+	delete pars;
+	return a;
+}
+
+/**
+ * Load the instances of a directory that have a best known value, in order of name
+ * @param directory
+ * @param best_known the file with a header line and a name and value per line
+ * @param filter only load instances whose name contains it
+ * @return
+ */
+static std::vector<instance> load(const std::string& directory, const std::string& best_known,
+                                  const std::string& filter) {
+	std::map<std::string, unsigned int> best;
+	std::ifstream                       file(best_known);
+	std::string                         name;
+	unsigned int                        value;
+	file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+	while (file >> name >> value) best[name] = value;
+
+	std::vector<std::string> names;
+	for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+		name = entry.path().filename().string();
+		if (name.find(filter) == std::string::npos || entry.path().extension() != ".dat") continue;
+		if (!best.contains(name)) {
+			std::cerr << "skipping " << name << ": no best known value\n";
+			continue;
+		}
+		names.push_back(name);
+	}
+	std::sort(names.begin(), names.end());
+
+	std::vector<instance> instances;
+	for (const auto& n : names) {
+		auto        path = (std::filesystem::path(directory) / n).string();
+		std::string error;
+		if (auto* p = read_problem(path.data(), &error)) instances.push_back({ n, p, best[n] });
+		else std::cerr << "skipping " << n << ": " << error << "\n";
+	}
+	return instances;
+}
+
+/**
+ * @param value
+ * @param best
+ * @return the percentage deviation of a value from the best known value
+ */
+static double deviation(unsigned int value, unsigned int best) {
+	return 100.0 * (static_cast<double>(best) - static_cast<double>(value)) /
+	       static_cast<double>(best);
+}
+
+/**
+ * @param r
+ * @param level a percentage deviation from the best known value
+ * @return the milliseconds until the run first reached the level, or -1 when it never did
+ */
+static long time_to_target(const run& r, double level) {
+	for (const auto& update : r.trace)
+		if (update.gap <= level + 1e-9) return update.elapsed.count();
+	return -1;
+}
+
+/**
+ * @param values sorted
+ * @param q
+ * @return the q-quantile
+ */
+static double quantile(const std::vector<double>& values, double q) {
+	if (values.empty()) return 0;
+	return values[static_cast<size_t>(q * static_cast<double>(values.size() - 1))];
+}
+
+/**
+ * Run an (algorithm x budget fraction x instance x seed) grid of solves in one process on parallel
+ * worker threads and report the percentage deviation from the best known values and the run-time
+ * distributions of reaching every quality level
+ * usage: mkp-bench [--instances directory] [--best-known file] [--filter name]
+ *                  [--algorithms "flags;flags;..."] [--fractions f,f,...] [--seeds N]
+ *                  [--levels l,l,...] [--workers N] [--csv prefix] [--json file]
+ */
+int main(int argc, char* argv[]) {
+	std::string directory  = "mkp_instances/instances";
+	std::string best_known = "mkp_instances/best_known_values.txt";
+	std::string filter, csv, json;
+	std::string algorithms = "--MA;--SA";
+	std::string fractions  = "0.01";
+	std::string levels     = "2,1,0.5,0.25,0.1,0";
+	int         seeds      = 1;
+	size_t      workers    = std::max(std::thread::hardware_concurrency(), 1u);
+
+	for (int i = 1; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "--instances") == 0) directory = argv[i + 1];
+		else if (strcmp(argv[i], "--best-known") == 0)
+			best_known = argv[i + 1];
+		else if (strcmp(argv[i], "--filter") == 0)
+			filter = argv[i + 1];
+		else if (strcmp(argv[i], "--algorithms") == 0)
+			algorithms = argv[i + 1];
+		else if (strcmp(argv[i], "--fractions") == 0)
+			fractions = argv[i + 1];
+		else if (strcmp(argv[i], "--seeds") == 0)
+			seeds = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--levels") == 0)
+			levels = argv[i + 1];
+		else if (strcmp(argv[i], "--workers") == 0)
+			workers = std::max<size_t>(strtoul(argv[i + 1], nullptr, 10), 1);
+		else if (strcmp(argv[i], "--csv") == 0)
+			csv = argv[i + 1];
+		else if (strcmp(argv[i], "--json") == 0)
+			json = argv[i + 1];
+	}
+
+	std::vector<algorithm> algs;
+	for (const auto& flags : split(algorithms, ';')) {
+		algs.push_back(parse_algorithm(flags));
+		if (!valid_options(algs.back().o)) {
+			std::cerr << "mkp-bench: invalid options of the algorithm \"" << flags << "\"\n";
+			return 1;
+		}
+	}
+	std::vector<double> budget_fractions, quality_levels;
+	for (const auto& f : split(fractions, ',')) budget_fractions.push_back(std::stod(f));
+	for (const auto& l : split(levels, ',')) quality_levels.push_back(std::stod(l));
+	const auto instances = load(directory, best_known, filter);
+
+	std::vector<run> runs;
+	for (size_t a = 0; a < algs.size(); ++a)
+		for (double fraction : budget_fractions)
+			for (size_t i = 0; i < instances.size(); ++i)
+				for (int seed = 1; seed <= seeds; ++seed)
+					runs.push_back({ a, fraction, i, seed, false, 0, {}, {} });
+
+	// The workers take the runs in order, every run is an independent solve
+	std::atomic<size_t> next = 0;
+	std::atomic<size_t> done = 0;
+	auto                work = [&] {
+		for (size_t k; (k = next++) < runs.size();) {
+			auto&       r = runs[k];
+			const auto& p = *instances[r.instance].p;
+
+			options o     = algs[r.algorithm].o;
+			o.seed        = r.seed;
+			o.limits.time = milliseconds(static_cast<long>(r.fraction * 1000.0 * p.runtime()));
+			o.best_known  = instances[r.instance].best;
+			// The trace delivers the improvements in order from a thread of its own
+			o.on_incumbent = [&](const incumbent& update) { r.trace.push_back(update); };
+
+			if (auto result = solve(p, o)) {
+				r.solved = true;
+				r.value  = result->best.value;
+				r.stats  = result->stats;
+			} else {
+				std::cerr << "\n" << algs[r.algorithm].name << " on " << instances[r.instance].name
+				          << " with seed " << r.seed << ": the solve was rejected\n";
+			}
+			std::cerr << "\r" << ++done << "/" << runs.size() << " runs" << std::flush;
+		}
+	};
+
+	const auto                begin = steady_clock::now();
+	std::vector<std::jthread> threads;
+	for (size_t w = 1; w < std::min(workers, runs.size()); ++w) threads.emplace_back(work);
+	work();
+	threads.clear();
+	const auto wall = duration<double>(steady_clock::now() - begin).count();
+	std::cerr << "\n";
+
+	// A rejected solve has no value, it would count as a deviation of 100%
+	const size_t rejected = std::erase_if(runs, [](const run& r) { return !r.solved; });
+	if (rejected) std::cerr << rejected << " rejected runs are left out of the results\n";
+
+	// Summary per algorithm and budget fraction
+	double cpu = 0;
+	for (const auto& r : runs) cpu += duration<double>(r.stats.elapsed).count();
+	std::cout << runs.size() << " runs in " << wall << " s on " << workers << " workers (" << cpu
+	          << " s of solving)\n";
+	for (size_t a = 0; a < algs.size(); ++a) {
+		for (double fraction : budget_fractions) {
+			std::map<int, std::vector<double>> by_size;
+			std::vector<double>                all;
+			for (const auto& r : runs) {
+				if (r.algorithm != a || r.fraction != fraction) continue;
+				const auto& inst = instances[r.instance];
+				all.push_back(deviation(r.value, inst.best));
+				by_size[inst.p->n].push_back(all.back());
+			}
+			auto mean = [](const std::vector<double>& v) {
+				double sum = 0;
+				for (auto x : v) sum += x;
+				return v.empty() ? 0 : sum / static_cast<double>(v.size());
+			};
+
+			std::cout << algs[a].name << " at " << fraction << " of the runtime: mean deviation "
+			          << mean(all) << "%";
+			for (const auto& [n, deviations] : by_size)
+				std::cout << ", n = " << n << ": " << mean(deviations) << "%";
+			std::cout << "\n";
+
+			// The run-time distribution of every quality level over the solved runs
+			for (double level : quality_levels) {
+				std::vector<double> times;
+				size_t              count = 0;
+				for (const auto& r : runs) {
+					if (r.algorithm != a || r.fraction != fraction) continue;
+					++count;
+					auto t = time_to_target(r, level);
+					if (t >= 0) times.push_back(static_cast<double>(t));
+				}
+				std::sort(times.begin(), times.end());
+				std::cout << "  within " << level << "%: "
+				          << 100.0 * static_cast<double>(times.size()) /
+				                 static_cast<double>(std::max<size_t>(count, 1))
+				          << "% of the runs";
+				if (!times.empty())
+					std::cout << ", time to target median " << quantile(times, 0.5) << " ms, 90% "
+					          << quantile(times, 0.9) << " ms";
+				std::cout << "\n";
+			}
+		}
+	}
+
+	if (!csv.empty()) {
+		std::ofstream out(csv + ".runs.csv");
+		out << "algorithm,fraction,instance,seed,value,best,deviation,elapsed_ms,iterations,"
+		       "evaluations\n";
+		for (const auto& r : runs) {
+			const auto& inst = instances[r.instance];
+			out << '"' << algs[r.algorithm].name << "\"," << r.fraction << ',' << inst.name << ','
+			    << r.seed << ',' << r.value << ',' << inst.best << ','
+			    << deviation(r.value, inst.best) << ',' << r.stats.elapsed.count() << ','
+			    << r.stats.iterations << ',' << r.stats.evaluations << '\n';
+		}
+
+		std::ofstream rtd(csv + ".rtd.csv");
+		rtd << "algorithm,fraction,instance,seed,level,time_to_target_ms\n";
+		for (const auto& r : runs) {
+			const auto& inst = instances[r.instance];
+			for (double level : quality_levels) {
+				auto t = time_to_target(r, level);
+				rtd << '"' << algs[r.algorithm].name << "\"," << r.fraction << ',' << inst.name
+				    << ',' << r.seed << ',' << level << ',';
+				if (t >= 0) rtd << t;
+				rtd << '\n';
+			}
+		}
+	}
+
+	if (!json.empty()) {
+		std::ofstream out(json);
+		out << "{\"runs\": [";
+		for (size_t k = 0; k < runs.size(); ++k) {
+			const auto& r    = runs[k];
+			const auto& inst = instances[r.instance];
+			out << (k ? ",\n  " : "\n  ") << "{\"algorithm\": \"" << algs[r.algorithm].name
+			    << "\", \"fraction\": " << r.fraction << ", \"instance\": \"" << inst.name
+			    << "\", \"seed\": " << r.seed << ", \"value\": " << r.value
+			    << ", \"best\": " << inst.best
+			    << ", \"deviation\": " << deviation(r.value, inst.best)
+			    << ", \"elapsed_ms\": " << r.stats.elapsed.count()
+			    << ", \"iterations\": " << r.stats.iterations
+			    << ", \"evaluations\": " << r.stats.evaluations << ", \"time_to_target_ms\": {";
+			for (size_t l = 0; l < quality_levels.size(); ++l) {
+				auto t = time_to_target(r, quality_levels[l]);
+				out << (l ? ", " : "") << '"' << quality_levels[l] << "\": ";
+				if (t >= 0) out << t;
+				else
+					out << "null";
+			}
+			out << "}}";
+		}
+		out << "\n]}\n";
+	}
+
+	for (const auto& inst : instances) delete inst.p;
+	return 0;
+}
@@ -0,0 +1,76 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#ifndef MKP_BENCH_INSTANCES_H
+#define MKP_BENCH_INSTANCES_H
+
+#include "mkpproblem.h"
+
+#include <cstddef>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * The random instance of the benchmarks and tests: weights in [1, 1000], profits correlated with
+ * the mean weight of the item and capacities at half the total weights, like the OR instances
+ * with tightness 0.5. The same n and m always give the same instance.
+ */
+struct random_instance {
+	size_t                        n, m;
+	std::vector<int>              profits;
+	// m rows of n weights, like the instance file
+	std::vector<std::vector<int>> weights;
+	std::vector<int>              capacities;
+	// The generator of the instance, it continues with the random choices of the caller
+	std::mt19937                  gen{ 42 };
+
+	random_instance(size_t n, size_t m): n(n), m(m), weights(m, std::vector<int>(n)) {
+		std::uniform_int_distribution<int> weight(1, 1000);
+		for (auto& row : weights)
+			for (auto& w : row) w = weight(gen);
+
+		for (size_t j = 0; j < n; ++j) {
+			long correlated = 0;
+			for (size_t i = 0; i < m; ++i) correlated += weights[i][j];
+			profits.push_back(weight(gen) + static_cast<int>(correlated / static_cast<long>(m)));
+		}
+		for (const auto& row : weights) {
+			long total = 0;
+			for (auto w : row) total += w;
+			capacities.push_back(static_cast<int>(total / 2));
+		}
+	}
+
+	/**
+	 * Write the instance in the OR-Library format
+	 * @param filename
+	 */
+	void write(const std::string& filename) const {
+		std::ofstream out(filename);
+		out << n << " " << m << " 0\n";
+		for (auto profit : profits) out << profit << " ";
+		out << "\n";
+		for (const auto& row : weights) {
+			for (auto w : row) out << w << " ";
+			out << "\n";
+		}
+		for (auto capacity : capacities) out << capacity << " ";
+		out << "\n";
+	}
+
+	/**
+	 * @return the instance as a problem, owned by the caller
+	 */
+	[[nodiscard]] problem* build() const {
+		std::vector<int> constraints;
+		for (const auto& row : weights)
+			constraints.insert(constraints.end(), row.begin(), row.end());
+		return build_problem(static_cast<int>(n), static_cast<int>(m), profits.data(),
+		                     constraints.data(), capacities.data());
+	}
+};
+
+#endif    // MKP_BENCH_INSTANCES_H
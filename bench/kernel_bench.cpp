@@ -0,0 +1,133 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "instances.h"
+#include "kernels.h"
+#include "reference.h"
+#include "util.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std::chrono;
+
+/**
+ * Synthetic resource state: a random item stream over the weights of the random instance against
+ * nearly full knapsacks. The slack is set so about half of the adds are feasible, independent of m.
+ */
+struct workload {
+	size_t                     m;
+	size_t                     stride;
+	std::vector<int>           weights;
+	std::vector<int>           capacities;
+	std::vector<int>           used;
+	std::vector<unsigned int>  stream;
+
+	workload(size_t m, size_t items, size_t operations):
+		m(m), stride(padded(m)), weights(items * stride, 0), capacities(stride, 0),
+		used(stride, 0), stream(operations) {
+		random_instance instance(items, m);
+		const int slack = static_cast<int>(1000 * std::pow(0.5, 1.0 / static_cast<double>(m)));
+		std::uniform_int_distribution<unsigned int> item(0, items - 1);
+
+		for (size_t j = 0; j < items; ++j)
+			for (size_t i = 0; i < m; ++i) weights[j * stride + i] = instance.weights[i][j];
+		for (size_t i = 0; i < m; ++i) {
+			capacities[i] = 10000;
+			used[i]       = capacities[i] - slack;
+		}
+		for (auto& s : stream) s = item(instance.gen);
+	}
+};
+
+/**
+ * Time adding every item of the stream and removing it again on success
+ * @return nanoseconds per add and the fraction of successful adds
+ */
+template<class Add, class Remove>
+static std::pair<double, double> run(workload w, size_t length, Add add, Remove remove) {
+	size_t added = 0;
+	auto   begin = steady_clock::now();
+	for (auto item : w.stream) {
+		const int* weights = w.weights.data() + item * w.stride;
+		if (add(w.used.data(), weights, w.capacities.data(), length)) {
+			remove(w.used.data(), weights, length);
+			++added;
+		}
+	}
+	auto ns = duration<double, std::nano>(steady_clock::now() - begin).count();
+
+	return { ns / static_cast<double>(w.stream.size()),
+		     static_cast<double>(added) / static_cast<double>(w.stream.size()) };
+}
+
+/**
+ * The fixed width kernels compiled with the instruction set of the build, behind a call like the
+ * dispatched ones, so the loop around them cannot fold the add and remove together
+ */
+template<size_t L>
+[[gnu::noinline]] static bool add_build(int* used, const int* weights, const int* capacities,
+                                        size_t) {
+	return add_fixed<L>(used, weights, capacities);
+}
+
+template<size_t L>
+[[gnu::noinline]] static void remove_build(int* used, const int* weights, size_t) {
+	remove_fixed<L>(used, weights);
+}
+
+/**
+ * Time the fixed width kernels of the Solution specialisations: compiled for the build, and
+ * dispatched for every instruction set the CPU supports
+ * @tparam L the padded length
+ * @param w
+ */
+template<size_t L> static void run_fixed(const workload& w) {
+	std::cout << "  fixed " << L << " build: " << run(w, L, add_build<L>, remove_build<L>).first
+	          << " ns/op\n";
+
+	for (const auto* k : { &fixed_kernels<L>::scalar, &fixed_kernels<L>::avx2,
+	                       &fixed_kernels<L>::avx512 }) {
+		if (!k->supported()) continue;
+		const auto add    = [k](int* u, const int* x, const int* c, size_t) {
+			return k->add(u, x, c);
+		};
+		const auto remove = [k](int* u, const int* x, size_t) { k->remove(u, x); };
+		std::cout << "  fixed " << L << " " << k->name << ": " << run(w, L, add, remove).first
+		          << " ns/op\n";
+	}
+}
+
+/**
+ * Compare the resource kernels for m = 5, 10 and 30
+ * usage: mkp-kernel-bench [operations]
+ */
+int main(int argc, char* argv[]) {
+	const size_t operations = argc > 1 ? std::stoul(argv[1]) : 20000000;
+
+	std::cout << "active kernels: " << active_kernels.name << ", fixed width "
+	          << fixed_kernels<16>::active.name << std::endl;
+	for (size_t m : { 5, 10, 30 }) {
+		workload w(m, 4096, operations);
+
+		auto [ns, rate] = run(w, m, add_reference, remove_reference);
+		std::cout << "m = " << m << " (" << rate * 100 << "% feasible)\n";
+		std::cout << "  reference: " << ns << " ns/op\n";
+
+		for (const auto* k : { &scalar_kernels, &avx2_kernels, &avx512_kernels }) {
+			if (!k->supported()) continue;
+			std::cout << "  " << k->name << ": " << run(w, w.stride, k->add, k->remove).first
+			          << " ns/op\n";
+		}
+
+		// The fixed width kernels of the Solution specialisations
+		if (w.stride == 16) run_fixed<16>(w);
+		else if (w.stride == 32)
+			run_fixed<32>(w);
+	}
+
+	return 0;
+}
@@ -0,0 +1,115 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "instances.h"
+#include "util.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+using namespace std::chrono;
+
+/**
+ * The original products: plain double loops over a vector of booleans or doubles
+ */
+static Vector<double> product_reference(const Vector<bool>& c, const Matrix<double>& m) {
+	Vector<double> r(m.columns(), 0);
+	for (size_t i = 0; i < m.rows(); ++i)
+		for (size_t j = 0; j < m.columns(); ++j) r[j] += m(i, j) * c[i];
+	return r;
+}
+
+static Vector<double> product_reference(const Vector<double>& c, const Matrix<double>& m) {
+	Vector<double> r(m.columns(), 0);
+	for (size_t i = 0; i < m.rows(); ++i)
+		for (size_t j = 0; j < m.columns(); ++j) r[j] += m(i, j) * c[i];
+	return r;
+}
+
+/**
+ * The constraint matrices A (n x m) and A^T (m x n) of the random instance, scaled to [0, 1] with
+ * padded, aligned rows, and a random selection of about half the items, like the solutions repair
+ * starts from
+ */
+struct workload {
+	size_t       n, m;
+	double*      a;
+	double*      a_t;
+	Vector<bool> selected;
+
+	workload(size_t n, size_t m): n(n), m(m), selected(n) {
+		a   = static_cast<double*>(std::aligned_alloc(64, n * padded(m) * sizeof(double)));
+		a_t = static_cast<double*>(std::aligned_alloc(64, m * padded(n) * sizeof(double)));
+		std::memset(a, 0, n * padded(m) * sizeof(double));
+		std::memset(a_t, 0, m * padded(n) * sizeof(double));
+
+		random_instance instance(n, m);
+		for (size_t i = 0; i < n; ++i) {
+			selected[i] = instance.gen() & 1;
+			for (size_t j = 0; j < m; ++j)
+				a[i * padded(m) + j] = a_t[j * padded(n) + i] = instance.weights[j][i] / 1000.0;
+		}
+	}
+
+	~workload() {
+		free(a);
+		free(a_t);
+	}
+
+	[[nodiscard]] Matrix<double> A() const { return { a, n, m, padded(m) }; }
+	[[nodiscard]] Matrix<double> A_t() const { return { a_t, m, n, padded(n) }; }
+};
+
+/**
+ * Time a product
+ * @return nanoseconds per call
+ */
+template<class F> static double time(size_t repetitions, F&& f) {
+	double sink  = 0;
+	auto   begin = steady_clock::now();
+	for (size_t r = 0; r < repetitions; ++r) {
+		auto result = f();
+		if (!result.empty()) sink += result.front();
+	}
+	auto ns = duration<double, std::nano>(steady_clock::now() - begin).count();
+	if (sink == -1) std::cout << sink;
+	return ns / static_cast<double>(repetitions);
+}
+
+/**
+ * Compare the original and the vectorized products used by repair: U = S^T * A on the selected
+ * items, then V = U^T * A^T
+ * usage: mkp-matrix-bench [m] [repetitions]
+ */
+int main(int argc, char* argv[]) {
+	const size_t m           = argc > 1 ? std::stoul(argv[1]) : 10;
+	const size_t repetitions = argc > 2 ? std::stoul(argv[2]) : 2000;
+
+	for (size_t n : { 100, 250, 500, 10000 }) {
+		workload     w(n, m);
+		const auto   A = w.A(), A_t = w.A_t();
+		Bitset       selected(n);
+		for (size_t i = 0; i < n; ++i)
+			if (w.selected[i]) selected.set(i);
+		const auto   u = product_reference(w.selected, A);
+
+		const bool equal = product_reference(w.selected, A) == selected * A &&
+		                   product_reference(u, A_t) == u * A_t;
+		const size_t scale = std::max<size_t>(1, 10000 / n);
+
+		std::cout << "n = " << n << ", m = " << m << (equal ? "" : " MISMATCH") << "\n";
+		std::cout << "  S^T * A reference: "
+		          << time(repetitions * scale, [&] { return product_reference(w.selected, A); })
+		          << " ns, masked: " << time(repetitions * scale, [&] { return selected * A; })
+		          << " ns\n";
+		std::cout << "  U^T * A^T reference: "
+		          << time(repetitions * scale, [&] { return product_reference(u, A_t); })
+		          << " ns, " << (n <= 2048 ? "single pass" : "blocked") << ": "
+		          << time(repetitions * scale, [&] { return u * A_t; })
+		          << " ns\n";
+	}
+
+	return 0;
+}
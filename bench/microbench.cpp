@@ -0,0 +1,192 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "engine.h"
+#include "instances.h"
+#include "mkpproblem.h"
+#include "rng.h"
+#include "solution.h"
+
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <map>
+
+/**
+ * The private kernels of Solution the benchmarks time
+ */
+struct kernel_access {
+	template<size_t W> static bool add(Solution<W>& s, size_t item, const problem& p) {
+		return s.add(item, p);
+	}
+
+	template<size_t W> static void remove_unchecked(Solution<W>& s, size_t item, const problem& p) {
+		s.remove_unchecked(item, p);
+	}
+
+	template<size_t W> static void commit(Solution<W>& s) { s.commit(); }
+
+	template<size_t W> static unsigned int random_item(const Solution<W>& s) {
+		return s.random_item();
+	}
+
+	template<size_t W> static void repair(Solution<W>& s, const problem& p) { s.repair(p); }
+
+	template<size_t W> static void mutate(Solution<W>& s, const problem& p) { s.mutate(p); }
+};
+
+/**
+ * An instance of n items and m knapsacks: the first OR instance with tightness 0.5 when it is
+ * bundled, a random one otherwise. Instances are loaded once and kept for the whole run.
+ * @param n
+ * @param m
+ * @return
+ */
+static const problem& instance(int64_t n, int64_t m) {
+	static std::map<std::pair<int64_t, int64_t>, const problem*> loaded;
+	auto& p = loaded[{ n, m }];
+	if (p) return *p;
+
+	auto bundled = "mkp_instances/instances/OR" + std::to_string(m) + "x" + std::to_string(n) +
+	               "-0.50_1.dat";
+	if (std::filesystem::exists(bundled)) p = read_problem(bundled.data());
+	else
+		p = random_instance(static_cast<size_t>(n), static_cast<size_t>(m)).build();
+	return *p;
+}
+
+/**
+ * Run a benchmark on the instance of its arguments with the Solution specialised for its width
+ * @param state
+ * @param f called with the state, the problem and a random solution
+ */
+template<class F> static void with_solution(benchmark::State& state, F&& f) {
+	const auto& p = instance(state.range(0), state.range(1));
+	generator() = rng(0);
+	with_width(p, [&](auto width) {
+		f(state, p, Solution<decltype(width)::value>(p, random_ch{}));
+	});
+	state.SetItemsProcessed(state.iterations());
+}
+
+// Remove a random selected item and add it back, the moves of the neighbourhoods
+static void BM_add_remove(benchmark::State& state) {
+	with_solution(state, [](benchmark::State& state, const problem& p, auto s) {
+		for (auto _ : state) {
+			const auto item = kernel_access::random_item(s);
+			kernel_access::remove_unchecked(s, item, p);
+			benchmark::DoNotOptimize(kernel_access::add(s, item, p));
+			kernel_access::commit(s);
+		}
+	});
+}
+
+// Try to add every item in turn to a maximal solution: the selected ones are rejected right away,
+// the others by the capacity check that fails most of the time in repair
+static void BM_add_rejected(benchmark::State& state) {
+	with_solution(state, [](benchmark::State& state, const problem& p, auto s) {
+		size_t item = 0;
+		for (auto _ : state) {
+			benchmark::DoNotOptimize(kernel_access::add(s, item, p));
+			if (++item == static_cast<size_t>(p.n)) item = 0;
+		}
+	});
+}
+
+static void BM_random_item(benchmark::State& state) {
+	with_solution(state, [](benchmark::State& state, const problem&, auto s) {
+		for (auto _ : state) benchmark::DoNotOptimize(kernel_access::random_item(s));
+	});
+}
+
+// Construct a solution from scratch with Toyoda
+static void BM_toyoda(benchmark::State& state) {
+	with_solution(state, [](benchmark::State& state, const problem& p, auto s) {
+		using S = decltype(s);
+		for (auto _ : state) benchmark::DoNotOptimize(S(p, toyoda_ch{}).profit());
+	});
+}
+
+static void BM_copy(benchmark::State& state) {
+	with_solution(state, [](benchmark::State& state, const problem&, auto s) {
+		for (auto _ : state) {
+			auto c = s;
+			benchmark::DoNotOptimize(c);
+		}
+	});
+}
+
+static void BM_crossover(benchmark::State& state) {
+	with_solution(state, [](benchmark::State& state, const problem& p, auto a) {
+		const decltype(a) b(p, random_ch{});
+		for (auto _ : state) benchmark::DoNotOptimize(crossover(a, b, p).profit());
+	});
+}
+
+static void BM_mutate(benchmark::State& state) {
+	with_solution(state, [](benchmark::State& state, const problem& p, auto s) {
+		for (auto _ : state) {
+			kernel_access::mutate(s, p);
+			benchmark::DoNotOptimize(s.profit());
+		}
+	});
+}
+
+// Repair a mutated crossover child, this includes a copy of the child
+static void BM_repair(benchmark::State& state) {
+	with_solution(state, [](benchmark::State& state, const problem& p, auto a) {
+		const decltype(a) b(p, random_ch{});
+		auto              child = crossover(a, b, p);
+		kernel_access::mutate(child, p);
+		for (auto _ : state) {
+			auto c = child;
+			kernel_access::repair(c, p);
+			benchmark::DoNotOptimize(c.profit());
+		}
+	});
+}
+
+// U = S^T * A, the rows of the selected items summed
+static void BM_masked_product(benchmark::State& state) {
+	with_solution(state, [](benchmark::State& state, const problem& p, auto s) {
+		for (auto _ : state) benchmark::DoNotOptimize((s.items() * p.A).front());
+	});
+}
+
+// V = U * A^T, U over all rows of the resource-major matrix
+static void BM_transposed_product(benchmark::State& state) {
+	with_solution(state, [](benchmark::State& state, const problem& p, auto s) {
+		const auto u = s.items() * p.A;
+		for (auto _ : state) benchmark::DoNotOptimize((u * p.A_t).front());
+	});
+}
+
+// A neighbour of simulated annealing at the initial temperature
+static void BM_anneal(benchmark::State& state) {
+	with_solution(state, [](benchmark::State& state, const problem& p, auto s) {
+		const auto T = p.initial_temperature();
+		for (auto _ : state) benchmark::DoNotOptimize(s.anneal(p, T));
+	});
+}
+
+// The bundled OR instances and larger random ones, every width of Solution is covered
+static void sizes(benchmark::internal::Benchmark* b) {
+	b->ArgNames({ "n", "m" });
+	for (int64_t n : { 100, 250 }) b->Args({ n, 10 });
+	for (int64_t m : { 5, 30, 100 }) b->Args({ 250, m });
+	for (int64_t n : { 1000, 10000 }) b->Args({ n, 10 });
+}
+
+BENCHMARK(BM_add_remove)->Apply(sizes);
+BENCHMARK(BM_add_rejected)->Apply(sizes);
+BENCHMARK(BM_random_item)->Apply(sizes);
+BENCHMARK(BM_toyoda)->Apply(sizes);
+BENCHMARK(BM_copy)->Apply(sizes);
+BENCHMARK(BM_crossover)->Apply(sizes);
+BENCHMARK(BM_mutate)->Apply(sizes);
+BENCHMARK(BM_repair)->Apply(sizes);
+BENCHMARK(BM_masked_product)->Apply(sizes);
+BENCHMARK(BM_transposed_product)->Apply(sizes);
+BENCHMARK(BM_anneal)->Apply(sizes);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,123 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "mkpio.h"
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+using namespace std::chrono;
+
+/**
+ * The original loader: one fscanf per number and one allocation per item
+ * @param filename
+ */
+static void read_fscanf(const char* filename) {
+	FILE* f = fopen(filename, "r");
+	int   n = 0, m = 0, b = 0;
+	if (fscanf(f, "%d %d %d", &n, &m, &b) != 3) exit(1);
+
+	int*  profits     = static_cast<int*>(malloc(n * sizeof(int)));
+	int** constraints = static_cast<int**>(malloc(n * sizeof(int*)));
+	int*  capacities  = static_cast<int*>(malloc(m * sizeof(int)));
+	for (int j = 0; j < n; ++j) constraints[j] = static_cast<int*>(malloc(m * sizeof(int)));
+
+	int r = 0;
+	for (int j = 0; j < n; ++j) r += fscanf(f, "%d", &profits[j]);
+	for (int i = 0; i < m; ++i)
+		for (int j = 0; j < n; ++j) r += fscanf(f, "%d", &constraints[j][i]);
+	for (int i = 0; i < m; ++i) r += fscanf(f, "%d", &capacities[i]);
+	fclose(f);
+
+	for (int j = 0; j < n; ++j) free(constraints[j]);
+	free(constraints);
+	free(capacities);
+	free(profits);
+}
+
+/**
+ * The memory mapped loader
+ * @param filename
+ */
+static void read_mmap(const char* filename) {
+	std::string error;
+	auto        image = parse_instance(filename, error);
+}
+
+/**
+ * Map the binary sidecar of an instance
+ * @param filename
+ */
+static void read_mkpb(const char* filename) {
+	std::string error;
+	auto        image = map_image(sidecar_path(filename).c_str(), error);
+}
+
+/**
+ * Parse every file of the corpus repeatedly and return the throughput in MB/s
+ * @param files
+ * @param bytes the total size of the corpus
+ * @param repetitions
+ * @param read the loader
+ */
+static double throughput(const std::vector<std::string>& files, size_t bytes, int repetitions,
+                         void (*read)(const char*)) {
+	auto begin = steady_clock::now();
+	for (int r = 0; r < repetitions; ++r)
+		for (const auto& file : files) read(file.c_str());
+	auto seconds = duration<double>(steady_clock::now() - begin).count();
+
+	return static_cast<double>(bytes) * repetitions / seconds / 1e6;
+}
+
+/**
+ * Measure the load throughput of the text loaders and the binary images over an instance corpus
+ * usage: mkp-parse-bench [directory] [repetitions]
+ */
+int main(int argc, char* argv[]) {
+	const char* directory   = argc > 1 ? argv[1] : "mkp_instances/instances";
+	const int   repetitions = argc > 2 ? atoi(argv[2]) : 20;
+
+	std::vector<std::string> files;
+	size_t                   bytes = 0;
+	for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+		if (entry.path().extension() != ".dat") continue;
+		files.push_back(entry.path().string());
+		bytes += entry.file_size();
+	}
+
+	if (files.empty()) {
+		std::cerr << "no .dat instances found in " << directory << std::endl;
+		return 1;
+	}
+
+	std::cout << files.size() << " files, " << static_cast<double>(bytes) / 1e6 << " MB, "
+	          << repetitions << " repetitions" << std::endl;
+	std::cout << "fscanf: " << throughput(files, bytes, repetitions, read_fscanf) << " MB/s"
+	          << std::endl;
+	std::cout << "mmap:   " << throughput(files, bytes, repetitions, read_mmap) << " MB/s"
+	          << std::endl;
+
+	// Load the same instances from binary images written to a temporary directory
+	auto tmp = std::filesystem::temp_directory_path() / "mkp-parse-bench";
+	std::filesystem::create_directories(tmp);
+	std::vector<std::string> images;
+	for (const auto& file : files) {
+		auto        image = (tmp / std::filesystem::path(file).filename()).string();
+		std::string error;
+		auto        parsed = parse_instance(file.c_str(), error);
+		if (!parsed || !write_image(*parsed, sidecar_path(image.c_str()).c_str(), error)) {
+			std::cerr << error << std::endl;
+			return 1;
+		}
+		images.push_back(image);
+	}
+	std::cout << "mkpb:   " << throughput(images, bytes, repetitions, read_mkpb)
+	          << " MB/s (text equivalent)" << std::endl;
+	std::filesystem::remove_all(tmp);
+
+	return 0;
+}
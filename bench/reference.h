@@ -0,0 +1,82 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#ifndef MKP_BENCH_REFERENCE_H
+#define MKP_BENCH_REFERENCE_H
+
+#include "mkpproblem.h"
+#include "rng.h"
+#include "solution.h"
+#include "util.h"
+
+// The original implementations the benchmarks time and the tests check the optimised ones against
+
+/**
+ * The original add: check every resource, then update every resource, over the m real resources
+ */
+inline bool add_reference(int* used, const int* weights, const int* capacities, size_t m) {
+	for (size_t i = 0; i < m; ++i)
+		if (used[i] + weights[i] > capacities[i]) return false;
+	for (size_t i = 0; i < m; ++i) used[i] += weights[i];
+	return true;
+}
+
+inline void remove_reference(int* used, const int* weights, size_t m) {
+	for (size_t i = 0; i < m; ++i) used[i] -= weights[i];
+}
+
+/**
+ * The original crossover on plain arrays: visit every item and draw a coin for every item where
+ * the parents differ, then update the value and resources one item at a time
+ */
+struct reference_child {
+	Vector<bool> sol;
+	unsigned int value = 0;
+	Vector<int>  resources;
+
+	reference_child(const Bitset& a, const problem& p):
+		sol(a.size()), resources(static_cast<size_t>(p.m), 0) {
+		a.for_each([&](size_t item) {
+			sol[item] = true;
+			value += p.profits[item];
+			for (size_t i = 0; i < resources.size(); ++i) resources[i] += p.constraints(item, i);
+		});
+	}
+
+	void cross(const Bitset& a, const Bitset& b, const problem& p, rng& random) {
+		for (size_t item = 0; item < sol.size(); ++item) {
+			if (a[item] != b[item] && random.coin()) {
+				sol[item] = b[item];
+
+				auto sign = sol[item] ? 1 : -1;
+				value += sign * p.profits[item];
+				for (size_t i = 0; i < resources.size(); ++i)
+					resources[i] += sign * p.constraints(item, i);
+			}
+		}
+	}
+};
+
+/**
+ * The dispatch the engine used before the tag types: the constructive heuristic is called through a
+ * member function pointer the compiler cannot see through.
+ */
+template<size_t W> struct indirect_ch {
+	void (Solution<W>::*heuristic)(const problem&);
+};
+
+template<size_t W> void construct(Solution<W>& s, const problem& p, indirect_ch<W> ch) {
+	(s.*ch.heuristic)(p);
+}
+
+/**
+ * Hide the heuristic behind a volatile load so it stays an indirect call
+ */
+template<size_t W> indirect_ch<W> opaque(void (Solution<W>::*heuristic)(const problem&)) {
+	static void (Solution<W>::* volatile slot)(const problem&);
+	slot = heuristic;
+	return { slot };
+}
+
+#endif    // MKP_BENCH_REFERENCE_H
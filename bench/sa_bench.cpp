@@ -0,0 +1,54 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "engine.h"
+#include "instances.h"
+#include "mkpproblem.h"
+#include "rng.h"
+#include "solution.h"
+
+#include <chrono>
+#include <iostream>
+
+using namespace std::chrono;
+
+/**
+ * Measure the simulated annealing throughput: anneal steps at the initial temperature for about a
+ * second, starting from a random solution
+ * @return neighbours per second
+ */
+template<size_t W> static double throughput(const problem& p) {
+	generator() = rng(0);
+	Solution<W> s(p, random_ch{});
+	const auto  T = p.initial_temperature();
+
+	size_t neighbours = 0;
+	auto   begin      = steady_clock::now();
+	auto   elapsed    = 0.0;
+	while (elapsed < 1) {
+		for (int i = 0; i < 1000; ++i) s.anneal(p, T);
+		neighbours += 1000;
+		elapsed = duration<double>(steady_clock::now() - begin).count();
+	}
+	return static_cast<double>(neighbours) / elapsed;
+}
+
+/**
+ * Report the simulated annealing throughput in neighbours per second for n = 100, 250 and 10^4
+ * usage: mkp-sa-bench [m]
+ */
+int main(int argc, char* argv[]) {
+	const size_t m = argc > 1 ? std::stoul(argv[1]) : 10;
+
+	for (size_t n : { 100, 250, 10000 }) {
+		const problem* p = random_instance(n, m).build();
+		with_width(*p, [&](auto width) {
+			std::cout << "n = " << n << ", m = " << m << ": "
+			          << throughput<decltype(width)::value>(*p) << " neighbours/s\n";
+		});
+		delete p;
+	}
+
+	return 0;
+}
@@ -0,0 +1,29 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "budget.h"
+
+using namespace std::chrono;
+
+budget::budget(): budget(limits{}) {}
+
+budget::budget(const limits& limit, std::function<void(const progress&)> on_progress):
+	limit(limit), start(steady_clock::now()), on_progress(std::move(on_progress)) {
+	// An unlimited wall time would overflow the deadline
+	const auto remaining = duration_cast<milliseconds>(steady_clock::time_point::max() - start);
+	deadline = limit.time < remaining ? start + limit.time : steady_clock::time_point::max();
+}
+
+/**
+ * Raise the incumbent to a reported value and pass it on when it is still an improvement
+ * @param value
+ */
+void budget::improve(unsigned int value) {
+	unsigned int best = incumbent.load(std::memory_order_relaxed);
+	while (value > best && !incumbent.compare_exchange_weak(best, value)) {}
+	if (value <= best || !on_progress) return;
+
+	on_progress({ value, duration_cast<milliseconds>(elapsed()), iterations_spent(),
+	              evaluations_spent() });
+}
@@ -0,0 +1,158 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#ifndef MKP_BUDGET_H
+#define MKP_BUDGET_H
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <functional>
+
+/**
+ * A new best solution of a solve
+ */
+struct progress {
+	unsigned int              value;
+	std::chrono::milliseconds elapsed;
+	uint64_t                  iterations;
+	uint64_t                  evaluations;
+};
+
+/**
+ * The budget of one solve: wall time, iterations, evaluations, a target value and cancellation.
+ * Every solve has its own budget, so solves can run side by side in threads, and the threads of a
+ * parallel solve share it. It is checked in the inner loops: the counters are atomic and every
+ * thread only probes the clock once every probe_interval checks.
+ * The budget also keeps the best value reported to it and passes every improvement to an optional
+ * progress callback.
+ */
+class budget {
+public:
+	struct limits {
+		// Wall time from the construction of the budget
+		std::chrono::milliseconds time = std::chrono::milliseconds::max();
+		// Iterations of the search loop, a step of simulated annealing or a generation of the
+		// memetic algorithm
+		uint64_t iterations = UINT64_MAX;
+		// Solutions evaluated, the initial solutions and one per iteration
+		uint64_t evaluations = UINT64_MAX;
+		// Stop as soon as a solution reaches this value
+		unsigned int target = UINT_MAX;
+		// An external cancel flag that may be shared by several budgets, nullptr for none
+		const std::atomic<bool>* cancel = nullptr;
+	};
+
+private:
+	limits                                limit;
+	std::chrono::steady_clock::time_point start;
+	std::chrono::steady_clock::time_point deadline;
+
+	std::atomic<uint64_t>     iterations  = 0;
+	std::atomic<uint64_t>     evaluations = 0;
+	std::atomic<bool>         stopped     = false;
+	std::atomic<unsigned int> incumbent   = 0;
+
+	std::function<void(const progress&)> on_progress;
+
+	// Checks between two probes of the clock by a thread
+	static constexpr unsigned int probe_interval = 16;
+
+	bool stop() {
+		stopped.store(true, std::memory_order_relaxed);
+		return false;
+	}
+
+	void improve(unsigned int value);
+
+public:
+	/**
+	 * Start the clock of an unlimited budget, it only stops when cancelled
+	 */
+	budget();
+
+	/**
+	 * Start the clock
+	 * @param limit
+	 * @param on_progress called with every new best value, it may be called concurrently by the
+	 * threads of a parallel solve
+	 */
+	explicit budget(const limits& limit, std::function<void(const progress&)> on_progress = {});
+
+	budget(const budget&)            = delete;
+	budget& operator=(const budget&) = delete;
+
+	/**
+	 * Account for iterations and evaluations that are about to be done
+	 * @param n the iterations
+	 * @param e the evaluations
+	 * @return whether they may be done, false once the budget is exhausted
+	 */
+	bool spend(uint64_t n, uint64_t e) {
+		if (stopped.load(std::memory_order_relaxed)) return false;
+		if (iterations.fetch_add(n, std::memory_order_relaxed) + n > limit.iterations)
+			return stop();
+		if (evaluations.fetch_add(e, std::memory_order_relaxed) + e > limit.evaluations)
+			return stop();
+		if (limit.cancel && limit.cancel->load(std::memory_order_relaxed)) return stop();
+
+		thread_local unsigned int checks = 0;
+		if (++checks % probe_interval == 0 && std::chrono::steady_clock::now() >= deadline)
+			return stop();
+		return true;
+	}
+
+	/**
+	 * Report the value of a solution, the budget is exhausted once it reaches the target
+	 * @param value
+	 */
+	void report(unsigned int value) {
+		if (value >= limit.target) stop();
+		if (value > incumbent.load(std::memory_order_relaxed)) improve(value);
+	}
+
+	/**
+	 * Exhaust the budget, can be called from any thread
+	 */
+	void cancel() { stop(); }
+
+	/**
+	 * @return whether the budget is exhausted
+	 */
+	[[nodiscard]] bool exhausted() const { return stopped.load(std::memory_order_relaxed); }
+
+	/**
+	 * @return the wall time limit
+	 */
+	[[nodiscard]] std::chrono::milliseconds time_limit() const { return limit.time; }
+
+	/**
+	 * @return the time since the construction of the budget
+	 */
+	[[nodiscard]] std::chrono::steady_clock::duration elapsed() const {
+		return std::chrono::steady_clock::now() - start;
+	}
+
+	/**
+	 * @return the iterations spent
+	 */
+	[[nodiscard]] uint64_t iterations_spent() const {
+		return iterations.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * @return the evaluations spent
+	 */
+	[[nodiscard]] uint64_t evaluations_spent() const {
+		return evaluations.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * @return the best value reported
+	 */
+	[[nodiscard]] unsigned int best() const { return incumbent.load(std::memory_order_relaxed); }
+};
+
+#endif    // MKP_BUDGET_H
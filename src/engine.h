@@ -0,0 +1,548 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#ifndef MKP_ENGINE_H
+#define MKP_ENGINE_H
+
+#include "solution.h"
+#include "threads.h"
+#include "util.h"
+
+#include <atomic>
+#include <cstdint>
+
+/*
+ * The constructive heuristics, iterative improvement and stochastic local search algorithms are
+ * selected by the tag types in util.h and dispatched at compile time, so every combination
+ * compiles to direct calls the compiler can inline instead of calls through member function
+ * pointers and std::function.
+ */
+
+template<size_t W> void construct(Solution<W>& s, const problem& p, random_ch) { s.random(p); }
+
+template<size_t W> void construct(Solution<W>& s, const problem& p, greedy_ch) { s.greedy(p); }
+
+template<size_t W> void construct(Solution<W>& s, const problem& p, toyoda_ch) { s.toyoda(p); }
+
+/**
+ * Create a solution
+ * @param p
+ * @param ch the constructive heuristic to use
+ */
+template<size_t W> template<class CH> Solution<W>::Solution(const problem& p, CH ch): Solution(p) {
+	construct(*this, p, ch);
+	commit();
+}
+
+/**
+ * Explore the neighbourhood of the solution of size k until the criterion is met for the first
+ * time. All possible combinations of k item removals are tried through recursion.
+ * @param solution the solution to start from, it is only modified when the criterion is met
+ * @param p
+ * @param offset the offset in the removal order for the next item to be removed
+ * @param k the amount of items that need to be removed
+ * @param shuffled the removal order
+ * @param criterion the criterion for choosing the new solution in the neighbourhood
+ * @return the success of finding a matching neighbour
+ */
+template<size_t W, class F>
+bool explore_neighbourhood(Solution<W>& solution, const problem& p, size_t offset, const size_t k,
+                           const int* shuffled, F&& criterion) {
+	// No items are left to be removed
+	if (k == 0) {
+		// Apply the criterion and undo its changes to the solution if unsuccessful
+		// Return the success
+		auto checkpoint = solution.checkpoint();
+		bool success    = criterion(solution);
+		if (!success) solution.rollback(p, checkpoint);
+		return success;
+	};
+
+	// More items must be removed recursively in order starting at the offset
+	for (; offset < solution.sol.size(); ++offset) {
+		// Try to remove one item
+		auto checkpoint = solution.checkpoint();
+		if (!solution.remove(shuffled[offset], p)) continue;
+
+		// Recursively remove the next k - 1 items starting from offset + 1
+		// The item is blocked so the constructive heuristic won't consider it again
+		solution.block(shuffled[offset]);
+		bool found = explore_neighbourhood(solution, p, offset + 1, k - 1, shuffled, criterion);
+		solution.unblock(shuffled[offset]);
+
+		// Accept the first matching neighbour
+		if (found) return true;
+
+		// Otherwise, undo the removal and try removing the next item
+		solution.rollback(p, checkpoint);
+	}
+
+	return false;
+}
+
+/**
+ * Evaluate the neighbour without the item in place: remove it and complete the solution with the
+ * constructive heuristic. The changes are journaled so the neighbour can be rolled back.
+ * @param item a selected item
+ * @param p
+ * @param ch the constructive heuristic to use
+ */
+template<size_t W>
+template<class CH>
+void Solution<W>::evaluate_removal(size_t item, const problem& p, CH ch) {
+	remove_unchecked(item, p);
+
+	// The item is blocked so the constructive heuristic won't consider it again
+	block(item);
+	construct(*this, p, ch);
+	unblock(item);
+}
+
+/**
+ * A buffer of the calling thread that keeps its capacity from one call to the next. A thread_local
+ * names a different object on every thread, so a parallel algorithm takes a reference to the
+ * buffer of the thread that runs it and the workers of its pool reach the buffer through that
+ * reference.
+ * @tparam T
+ * @return
+ */
+template<class T> T& thread_buffer() {
+	thread_local T buffer;
+	return buffer;
+}
+
+/**
+ * The best neighbour found by one worker of the parallel iterative improvement algorithms
+ */
+template<class Move> struct worker_best {
+	static constexpr size_t none = SIZE_MAX;
+
+	unsigned int value    = 0;
+	size_t       position = none;
+	Vector<Move> moves;
+};
+
+/**
+ * Update the solution with the first improvement iterative improvement algorithm.
+ * Neighbours are evaluated in place and rolled back when they are not accepted.
+ * @param p
+ * @param ch the constructive heuristic to use
+ */
+template<size_t W>
+template<class CH>
+void Solution<W>::first_improvement(const problem& p, CH ch) {
+	// The random heuristic draws from the generator of the calling thread, it always runs
+	// sequentially so a seed gives the same result at any number of threads
+	if constexpr (!std::is_same_v<CH, random_ch>)
+		if (auto& pool = threads(); pool.size() > 1) return parallel_first_improvement(p, ch, pool);
+
+	commit();
+
+	// Keep improving until a local minimum is reached
+	bool changed;
+	do {
+		changed = false;
+		// Create the removal order
+		auto shuffled = create_shuffled(sol.size());
+
+		for (size_t i = 0; i < sol.size(); ++i) {
+			// Try to remove an item and apply the constructive heuristic after removal
+			if (!sol[shuffled[i]]) continue;
+			const auto current = value;
+			evaluate_removal(shuffled[i], p, ch);
+
+			// Accept the first improvement
+			if (value > current) {
+				commit();
+				changed = true;
+				break;
+			}
+			rollback(p);
+		}
+
+		free(shuffled);
+	} while (changed);
+}
+
+/**
+ * Speculative parallel first improvement. The workers claim removal positions in order and
+ * publish the lowest improving position they find, positions after it are no longer claimed.
+ * Every position before the lowest improving one is still evaluated, so the accepted neighbour
+ * is the one the sequential version accepts.
+ * @param p
+ * @param ch the constructive heuristic to use
+ * @param pool
+ */
+template<size_t W>
+template<class CH>
+void Solution<W>::parallel_first_improvement(const problem& p, CH ch, thread_pool& pool) {
+	// A scratch solution and the first improvement of every worker
+	auto& scratch = thread_buffer<std::vector<Solution>>();
+	auto& found   = thread_buffer<std::vector<worker_best<move>>>();
+	found.resize(pool.size());
+
+	commit();
+
+	// Keep improving until a local minimum is reached
+	bool changed;
+	do {
+		// Create the removal order
+		auto shuffled = create_shuffled(sol.size());
+
+		if (scratch.size() != pool.size()) scratch.assign(pool.size(), *this);
+		for (size_t w = 0; w < pool.size(); ++w) {
+			scratch[w]        = *this;
+			found[w].position = worker_best<move>::none;
+		}
+
+		std::atomic<size_t> next{ 0 };
+		std::atomic<size_t> first{ worker_best<move>::none };
+		pool.run([&](size_t worker) {
+			auto& s = scratch[worker];
+			for (size_t i; (i = next.fetch_add(1)) < sol.size() && i < first.load();) {
+				// Try to remove an item and apply the constructive heuristic after removal
+				if (!s.sol[shuffled[i]]) continue;
+				s.evaluate_removal(shuffled[i], p, ch);
+
+				// Positions claimed later by this worker are higher, so it can stop here
+				if (s.value > value) {
+					found[worker].position = i;
+					found[worker].moves.assign(s.journal.begin(), s.journal.end());
+					for (auto lowest = first.load(); i < lowest;)
+						if (first.compare_exchange_weak(lowest, i)) break;
+					s.rollback(p);
+					break;
+				}
+				s.rollback(p);
+			}
+		});
+
+		// Accept the first improvement
+		const auto best = std::min_element(found.begin(), found.end(), [](auto& a, auto& b) {
+			return a.position < b.position;
+		});
+		changed = best->position != worker_best<move>::none;
+		if (changed) {
+			replay(p, best->moves);
+			commit();
+		}
+
+		free(shuffled);
+	} while (changed);
+}
+
+/**
+ * Update the solution with the best improvement iterative improvement algorithm.
+ * Neighbours are evaluated in place and rolled back, only the moves of the best one are kept.
+ * @param p
+ * @param ch the constructive heuristic to use
+ */
+template<size_t W>
+template<class CH>
+void Solution<W>::best_improvement(const problem& p, CH ch) {
+	// The random heuristic draws from the generator of the calling thread, it always runs
+	// sequentially so a seed gives the same result at any number of threads
+	if constexpr (!std::is_same_v<CH, random_ch>)
+		if (auto& pool = threads(); pool.size() > 1) return parallel_best_improvement(p, ch, pool);
+
+	// The moves leading to the best neighbour so far
+	thread_local Vector<move> best_moves;
+
+	commit();
+
+	// Keep improving until a local minimum is reached
+	bool changed;
+	do {
+		changed = false;
+		// Create the removal order
+		auto shuffled = create_shuffled(sol.size());
+		// Initialize the best neighbour so far
+		auto best = value;
+
+		for (size_t i = 0; i < sol.size(); ++i) {
+			// Try to remove an item and apply the constructive heuristic after removal
+			if (!sol[shuffled[i]]) continue;
+			evaluate_removal(shuffled[i], p, ch);
+
+			// Remember the best improvement
+			if (value > best) {
+				best = value;
+				best_moves.assign(journal.begin(), journal.end());
+				changed = true;
+			}
+			rollback(p);
+		}
+
+		// Accept the best improvement
+		if (changed) {
+			replay(p, best_moves);
+			commit();
+		}
+
+		free(shuffled);
+	} while (changed);
+}
+
+/**
+ * Parallel best improvement. The removal positions are split dynamically across the workers,
+ * each keeps its best neighbour on a scratch solution. The reduction takes the highest value and
+ * the lowest removal position on ties, the neighbour the sequential version accepts.
+ * @param p
+ * @param ch the constructive heuristic to use
+ * @param pool
+ */
+template<size_t W>
+template<class CH>
+void Solution<W>::parallel_best_improvement(const problem& p, CH ch, thread_pool& pool) {
+	// A scratch solution and the best neighbour of every worker
+	auto& scratch = thread_buffer<std::vector<Solution>>();
+	auto& found   = thread_buffer<std::vector<worker_best<move>>>();
+	found.resize(pool.size());
+
+	commit();
+
+	// Keep improving until a local minimum is reached
+	bool changed;
+	do {
+		// Create the removal order
+		auto shuffled = create_shuffled(sol.size());
+
+		if (scratch.size() != pool.size()) scratch.assign(pool.size(), *this);
+		for (size_t w = 0; w < pool.size(); ++w) {
+			scratch[w]        = *this;
+			found[w].value    = value;
+			found[w].position = worker_best<move>::none;
+		}
+
+		std::atomic<size_t> next{ 0 };
+		pool.run([&](size_t worker) {
+			auto& s    = scratch[worker];
+			auto& best = found[worker];
+			for (size_t i; (i = next.fetch_add(1)) < sol.size();) {
+				// Try to remove an item and apply the constructive heuristic after removal
+				if (!s.sol[shuffled[i]]) continue;
+				s.evaluate_removal(shuffled[i], p, ch);
+
+				// Remember the best improvement, this worker claims positions in increasing order
+				if (s.value > best.value) {
+					best.value    = s.value;
+					best.position = i;
+					best.moves.assign(s.journal.begin(), s.journal.end());
+				}
+				s.rollback(p);
+			}
+		});
+
+		// Accept the best improvement
+		const auto best = std::min_element(found.begin(), found.end(), [](auto& a, auto& b) {
+			return a.value > b.value || (a.value == b.value && a.position < b.position);
+		});
+		changed = best->position != worker_best<move>::none;
+		if (changed) {
+			replay(p, best->moves);
+			commit();
+		}
+
+		free(shuffled);
+	} while (changed);
+}
+
+/**
+ * Update the solution with the variable neighborhood descent algorithm based on first improvement
+ * @param p
+ * @param ch the constructive heuristic to use
+ * @param deterministic whether the parallel version must accept the lexicographically first
+ * improvement like the sequential one, or may accept whichever improvement it finds first
+ */
+template<size_t W>
+template<class CH>
+void Solution<W>::variable_neighbourhood_descent(const problem& p, CH ch, bool deterministic) {
+	// The random heuristic draws from the generator of the calling thread, it always runs
+	// sequentially so a seed gives the same result at any number of threads
+	if constexpr (!std::is_same_v<CH, random_ch>)
+		if (auto& pool = threads(); pool.size() > 1)
+			return parallel_variable_neighbourhood_descent(p, ch, deterministic, pool);
+
+	commit();
+
+	// Initialize the neighbourhood size
+	size_t k = 1;
+	// Keep improving until a local minimum is reached in every neighbourhood
+	while (k < 4) {
+		// Create the removal order
+		auto       shuffled = create_shuffled(sol.size());
+		const auto current  = value;
+
+		// Explore the current neighbourhood in place until the criterion is reached for the first
+		// time, every other neighbour is rolled back
+		bool found = explore_neighbourhood(*this, p, 0, k, shuffled, [&](Solution& solution) {
+			// Apply the constructive heuristic after removal of k items
+			construct(solution, p, ch);
+			// Check if it is an improvement
+			return solution.value > current;
+		});
+
+		// If an improvement is found, return to the first neighbourhood, otherwise try the next one
+		if (found) {
+			commit();
+			k = 1;
+		} else {
+			++k;
+		}
+
+		free(shuffled);
+	}
+}
+
+/**
+ * Parallel variable neighbourhood descent. The tree of removal combinations is split into tasks
+ * by fixing the first k - 1 removals (at most two), in lexicographic order of their removal
+ * positions, and the tasks are run with work stealing. Each task explores the rest of its subtree
+ * on the scratch solution of its worker. Once an improvement is found, the tasks after it are
+ * cancelled. In deterministic mode the tasks before it still run to the end, so the accepted
+ * neighbour is the lexicographically first one, the one the sequential version accepts.
+ * Otherwise every task is cancelled.
+ * @param p
+ * @param ch the constructive heuristic to use
+ * @param deterministic
+ * @param pool
+ */
+template<size_t W>
+template<class CH>
+void Solution<W>::parallel_variable_neighbourhood_descent(const problem& p, CH ch,
+                                                          bool deterministic, thread_pool& pool) {
+	// A task fixes one or two removal positions
+	struct task {
+		size_t first;
+		size_t second;
+	};
+	constexpr size_t none = worker_best<move>::none;
+
+	// A scratch solution and the first improvement of every worker, and the tasks
+	auto& scratch = thread_buffer<std::vector<Solution>>();
+	auto& found   = thread_buffer<std::vector<worker_best<move>>>();
+	auto& tasks   = thread_buffer<Vector<task>>();
+	found.resize(pool.size());
+
+	commit();
+
+	// Initialize the neighbourhood size
+	size_t k = 1;
+	// Keep improving until a local minimum is reached in every neighbourhood
+	while (k < 4) {
+		// Create the removal order
+		auto       shuffled = create_shuffled(sol.size());
+		const auto current  = value;
+
+		// Only the positions of selected items can be removed
+		tasks.clear();
+		for (size_t a = 0; a < sol.size(); ++a) {
+			if (!sol[shuffled[a]]) continue;
+			if (k < 3) {
+				tasks.push_back({ a, none });
+				continue;
+			}
+			for (size_t b = a + 1; b < sol.size(); ++b)
+				if (sol[shuffled[b]]) tasks.push_back({ a, b });
+		}
+
+		if (scratch.size() != pool.size()) scratch.assign(pool.size(), *this);
+		for (size_t w = 0; w < pool.size(); ++w) {
+			scratch[w]        = *this;
+			found[w].position = none;
+		}
+
+		// The lowest task with an improvement so far
+		std::atomic<size_t> first{ none };
+		const auto          cancelled = [&](size_t t) {
+			const auto lowest = first.load(std::memory_order_relaxed);
+			return deterministic ? lowest < t : lowest != none;
+		};
+
+		pool.run_stealing(tasks.size(), [&](size_t worker, size_t t) {
+			if (cancelled(t)) return;
+			auto& s = scratch[worker];
+
+			// Apply the fixed removals, the items are blocked so the constructive heuristic
+			// won't consider them again
+			const auto [a, b] = tasks[t];
+			s.remove(shuffled[a], p);
+			s.block(shuffled[a]);
+			if (b != none) {
+				s.remove(shuffled[b], p);
+				s.block(shuffled[b]);
+			}
+
+			// Explore the rest of the subtree until an improvement is found or the task is
+			// cancelled
+			bool stopped  = false;
+			bool improved = explore_neighbourhood(
+				s, p, (b != none ? b : a) + 1, k - (b != none ? 2 : 1), shuffled,
+				[&](Solution& solution) {
+					if (cancelled(t)) return stopped = true;
+					construct(solution, p, ch);
+					return solution.value > current;
+				});
+
+			if (improved && !stopped) {
+				// This worker may have run a higher task with an improvement before
+				if (t < found[worker].position) {
+					found[worker].position = t;
+					found[worker].moves.assign(s.journal.begin(), s.journal.end());
+				}
+				for (auto lowest = first.load(); t < lowest;)
+					if (first.compare_exchange_weak(lowest, t)) break;
+			}
+
+			if (b != none) s.unblock(shuffled[b]);
+			s.unblock(shuffled[a]);
+			s.rollback(p);
+		});
+
+		// If an improvement is found, return to the first neighbourhood, otherwise try the next one
+		const auto best = std::min_element(found.begin(), found.end(), [](auto& a, auto& b) {
+			return a.position < b.position;
+		});
+		if (best->position != none) {
+			replay(p, best->moves);
+			commit();
+			k = 1;
+		} else {
+			++k;
+		}
+
+		free(shuffled);
+	}
+}
+
+template<size_t W, class CH>
+void improve(Solution<W>& s, const problem& p, CH ch, first_improvement_ii) {
+	s.first_improvement(p, ch);
+}
+
+template<size_t W, class CH>
+void improve(Solution<W>& s, const problem& p, CH ch, best_improvement_ii) {
+	s.best_improvement(p, ch);
+}
+
+template<size_t W, class CH> void improve(Solution<W>& s, const problem& p, CH ch, vnd_ii ii) {
+	s.variable_neighbourhood_descent(p, ch, ii.deterministic);
+}
+
+template<size_t W>
+Solution<W> search(const problem& p, simulated_annealing_sla sla, budget& b) {
+	if (sla.mode == annealing_mode::single) return simulated_annealing<W>(p, b);
+	return parallel_annealing<W>(p, sla, b);
+}
+
+template<size_t W> Solution<W> search(const problem& p, memetic_sla sla, budget& b) {
+	if (sla.islands == 1) return memetic_algorithm<W>(p, sla.population, b);
+	return island_model<W>(p, sla, b);
+}
+
+template<size_t W> Solution<W> search(const problem& p, tabu_search_sla sla, budget& b) {
+	return tabu_search<W>(p, sla, b);
+}
+
+#endif    // MKP_ENGINE_H
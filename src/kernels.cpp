@@ -0,0 +1,203 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "kernels.h"
+#include "util.h"
+
+#include <immintrin.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Scalar
+
+static bool add_scalar(int* used, const int* weights, const int* capacities, size_t length) {
+	for (size_t i = 0; i < length; ++i)
+		if (used[i] + weights[i] > capacities[i]) return false;
+
+	for (size_t i = 0; i < length; ++i) used[i] += weights[i];
+	return true;
+}
+
+static void remove_scalar(int* used, const int* weights, size_t length) {
+	for (size_t i = 0; i < length; ++i) used[i] -= weights[i];
+}
+
+static bool always() { return true; }
+
+const resource_kernels scalar_kernels{ add_scalar, remove_scalar, "scalar", always };
+
+template<size_t L>
+const fixed_kernels<L> fixed_kernels<L>::scalar{ add_fixed<L>, remove_fixed<L>, "scalar", always };
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// AVX2: a 64 byte block is two vectors of 8 ints
+
+#define AVX2 __attribute__((target("avx2")))
+
+AVX2 static inline __m256i load256(const int* p) {
+	return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+AVX2 static inline void store256(int* p, __m256i v) {
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+}
+
+AVX2 static bool add_avx2(int* used, const int* weights, const int* capacities, size_t length) {
+	// Fuse the check and the update when everything fits in one block, e.g. m <= 16
+	if (length == simd_width) {
+		__m256i lo = _mm256_add_epi32(load256(used), load256(weights));
+		__m256i hi = _mm256_add_epi32(load256(used + 8), load256(weights + 8));
+		__m256i violated = _mm256_or_si256(_mm256_cmpgt_epi32(lo, load256(capacities)),
+		                                   _mm256_cmpgt_epi32(hi, load256(capacities + 8)));
+		if (_mm256_movemask_epi8(violated)) return false;
+		store256(used, lo);
+		store256(used + 8, hi);
+		return true;
+	}
+
+	// Otherwise check every vector with an early out before updating
+	for (size_t i = 0; i < length; i += 8) {
+		__m256i sum = _mm256_add_epi32(load256(used + i), load256(weights + i));
+		if (_mm256_movemask_epi8(_mm256_cmpgt_epi32(sum, load256(capacities + i)))) return false;
+	}
+	for (size_t i = 0; i < length; i += 8)
+		store256(used + i, _mm256_add_epi32(load256(used + i), load256(weights + i)));
+	return true;
+}
+
+AVX2 static void remove_avx2(int* used, const int* weights, size_t length) {
+	for (size_t i = 0; i < length; i += 8)
+		store256(used + i, _mm256_sub_epi32(load256(used + i), load256(weights + i)));
+}
+
+/**
+ * AVX2 add for a fixed length: the sums stay in registers between the check and the update
+ * @tparam L the padded length
+ */
+template<size_t L>
+AVX2 static bool add_fixed_avx2(int* used, const int* weights, const int* capacities) {
+	__m256i sum[L / 8];
+	__m256i violated = _mm256_setzero_si256();
+	for (size_t i = 0; i < L / 8; ++i) {
+		sum[i]   = _mm256_add_epi32(load256(used + 8 * i), load256(weights + 8 * i));
+		violated = _mm256_or_si256(violated,
+		                           _mm256_cmpgt_epi32(sum[i], load256(capacities + 8 * i)));
+	}
+	if (_mm256_movemask_epi8(violated)) return false;
+
+	for (size_t i = 0; i < L / 8; ++i) store256(used + 8 * i, sum[i]);
+	return true;
+}
+
+template<size_t L> AVX2 static void remove_fixed_avx2(int* used, const int* weights) {
+	for (size_t i = 0; i < L; i += 8)
+		store256(used + i, _mm256_sub_epi32(load256(used + i), load256(weights + i)));
+}
+
+static bool supports_avx2() { return __builtin_cpu_supports("avx2"); }
+
+const resource_kernels avx2_kernels{ add_avx2, remove_avx2, "avx2", supports_avx2 };
+
+template<size_t L>
+const fixed_kernels<L> fixed_kernels<L>::avx2{ add_fixed_avx2<L>, remove_fixed_avx2<L>, "avx2",
+	                                           supports_avx2 };
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// AVX-512: a 64 byte block is one vector of 16 ints and the comparison yields a mask directly
+
+#define AVX512 __attribute__((target("avx512f")))
+
+AVX512 static bool add_avx512(int* used, const int* weights, const int* capacities,
+                              size_t length) {
+	// Fuse the check and the update when everything fits in one vector, e.g. m <= 16
+	if (length == simd_width) {
+		__m512i sum = _mm512_add_epi32(_mm512_loadu_si512(used), _mm512_loadu_si512(weights));
+		if (_mm512_cmpgt_epi32_mask(sum, _mm512_loadu_si512(capacities))) return false;
+		_mm512_storeu_si512(used, sum);
+		return true;
+	}
+
+	// Otherwise check every vector with an early out before updating
+	for (size_t i = 0; i < length; i += 16) {
+		__m512i sum =
+			_mm512_add_epi32(_mm512_loadu_si512(used + i), _mm512_loadu_si512(weights + i));
+		if (_mm512_cmpgt_epi32_mask(sum, _mm512_loadu_si512(capacities + i))) return false;
+	}
+	for (size_t i = 0; i < length; i += 16)
+		_mm512_storeu_si512(used + i, _mm512_add_epi32(_mm512_loadu_si512(used + i),
+		                                               _mm512_loadu_si512(weights + i)));
+	return true;
+}
+
+AVX512 static void remove_avx512(int* used, const int* weights, size_t length) {
+	for (size_t i = 0; i < length; i += 16)
+		_mm512_storeu_si512(used + i, _mm512_sub_epi32(_mm512_loadu_si512(used + i),
+		                                               _mm512_loadu_si512(weights + i)));
+}
+
+/**
+ * AVX-512 add for a fixed length: the masks of all vectors are combined before one branch
+ * @tparam L the padded length
+ */
+template<size_t L>
+AVX512 static bool add_fixed_avx512(int* used, const int* weights, const int* capacities) {
+	__m512i   sum[L / 16];
+	__mmask16 violated = 0;
+	for (size_t i = 0; i < L / 16; ++i) {
+		sum[i] = _mm512_add_epi32(_mm512_loadu_si512(used + 16 * i),
+		                          _mm512_loadu_si512(weights + 16 * i));
+		violated |= _mm512_cmpgt_epi32_mask(sum[i], _mm512_loadu_si512(capacities + 16 * i));
+	}
+	if (violated) return false;
+
+	for (size_t i = 0; i < L / 16; ++i) _mm512_storeu_si512(used + 16 * i, sum[i]);
+	return true;
+}
+
+template<size_t L> AVX512 static void remove_fixed_avx512(int* used, const int* weights) {
+	for (size_t i = 0; i < L; i += 16)
+		_mm512_storeu_si512(used + i, _mm512_sub_epi32(_mm512_loadu_si512(used + i),
+		                                               _mm512_loadu_si512(weights + i)));
+}
+
+static bool supports_avx512() { return __builtin_cpu_supports("avx512f"); }
+
+const resource_kernels avx512_kernels{ add_avx512, remove_avx512, "avx512", supports_avx512 };
+
+template<size_t L>
+const fixed_kernels<L> fixed_kernels<L>::avx512{ add_fixed_avx512<L>, remove_fixed_avx512<L>,
+	                                             "avx512", supports_avx512 };
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Select the widest kernels the CPU supports
+ * @return
+ */
+static const resource_kernels& select_kernels() {
+	// The CPU features have to be initialized explicitly during static initialization
+	__builtin_cpu_init();
+	if (avx512_kernels.supported()) return avx512_kernels;
+	if (avx2_kernels.supported()) return avx2_kernels;
+	return scalar_kernels;
+}
+
+const resource_kernels& active_kernels = select_kernels();
+
+/**
+ * Select the widest fixed length kernels the CPU supports
+ * @tparam L the padded length
+ * @return
+ */
+template<size_t L> static const fixed_kernels<L>& select_fixed_kernels() {
+	__builtin_cpu_init();
+	if (fixed_kernels<L>::avx512.supported()) return fixed_kernels<L>::avx512;
+	if (fixed_kernels<L>::avx2.supported()) return fixed_kernels<L>::avx2;
+	return fixed_kernels<L>::scalar;
+}
+
+template<size_t L> const fixed_kernels<L>& fixed_kernels<L>::active = select_fixed_kernels<L>();
+
+// The widths of the Solution specialisations
+template struct fixed_kernels<16>;
+template struct fixed_kernels<32>;
@@ -0,0 +1,75 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#ifndef MKP_KERNELS_H
+#define MKP_KERNELS_H
+
+#include <cstddef>
+
+/**
+ * Kernels updating the used resources of a solution with the weights of one item.
+ * All arrays are padded with zeros to a multiple of simd_width elements and length is that
+ * padded length.
+ */
+struct resource_kernels {
+	// Add the weights to the used resources if no capacity gets exceeded, returns success
+	bool (*add)(int* used, const int* weights, const int* capacities, size_t length);
+	// Subtract the weights from the used resources
+	void (*remove)(int* used, const int* weights, size_t length);
+	// Name of the instruction set
+	const char* name;
+	// Whether the CPU running the program supports the instruction set
+	bool (*supported)();
+};
+
+extern const resource_kernels scalar_kernels;
+extern const resource_kernels avx2_kernels;
+extern const resource_kernels avx512_kernels;
+
+// The fastest kernels supported by the CPU, selected once at startup
+extern const resource_kernels& active_kernels;
+
+/**
+ * Fixed length version of resource_kernels::add, the constant trip count lets the compiler fully
+ * unroll and vectorize both loops
+ * @tparam L the padded length
+ */
+template<size_t L> inline bool add_fixed(int* used, const int* weights, const int* capacities) {
+	int violated = 0;
+	for (size_t i = 0; i < L; ++i) violated |= used[i] + weights[i] > capacities[i];
+	if (violated) return false;
+
+	for (size_t i = 0; i < L; ++i) used[i] += weights[i];
+	return true;
+}
+
+/**
+ * Fixed length version of resource_kernels::remove
+ * @tparam L the padded length
+ */
+template<size_t L> inline void remove_fixed(int* used, const int* weights) {
+	for (size_t i = 0; i < L; ++i) used[i] -= weights[i];
+}
+
+/**
+ * resource_kernels for one padded length, used by the Solution specialisations of that width.
+ * Every instruction set gets its own fully unrolled instantiation, so the fixed widths keep the
+ * runtime dispatch of the variable length kernels.
+ * @tparam L the padded length, 16 or 32
+ */
+template<size_t L> struct fixed_kernels {
+	bool (*add)(int* used, const int* weights, const int* capacities);
+	void (*remove)(int* used, const int* weights);
+	const char* name;
+	bool (*supported)();
+
+	static const fixed_kernels scalar;
+	static const fixed_kernels avx2;
+	static const fixed_kernels avx512;
+
+	// The fastest fixed length kernels supported by the CPU, selected once at startup
+	static const fixed_kernels& active;
+};
+
+#endif    // MKP_KERNELS_H
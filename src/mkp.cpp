@@ -2,40 +2,93 @@
 // Created by ward on 3/14/22.
 //
 
-#include "solution.h"
+#include "solver.h"
 #include "util.h"
 
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+/**
+ * Print the result of a solve: the solution of the constructive heuristic and the improved one,
+ * or the solution of the stochastic local search algorithm
+ * @param r
+ * @param pars
+ */
+static void print(const result& r, const params& pars) {
+	if (!std::holds_alternative<std::monostate>(pars.SLA)) {
+		std::cout << r.best;
+		return;
+	}
+
+	if (verbose) std::cout << "After applying the constructive heuristic:" << std::endl;
+	std::cout << r.constructed.value_or(r.best);
+
+	if (r.constructed) {
+		if (verbose) std::cout << "After applying the iterative improvement algorithm:";
+		std::cout << std::endl << r.best;
+	}
+}
+
 int main(int argc, char* argv[]) {
 	params* pars = read_params(argc, argv);
-	set_seed(pars->seed);
+	verbose      = pars->verbose;
+	pars->log    = &std::cout;
 
-	problem* p = read_problem(pars->instance_file);
-	if (verbose) print_problem(p);
+	std::string error;
+	problem*    p = read_problem(pars->instance_file, &error);
+	if (!p) {
+		fprintf(stderr, "%s\n", error.c_str());
+		return 1;
+	}
 
-	if (pars->SLA) {
-		auto s = pars->SLA(*p);
-		std::cout << s;
-		s.validate(*p);
-		return 0;
+	if (pars->convert) {
+		const auto sidecar = sidecar_path(pars->instance_file);
+		const bool written = write_image(*p->image, sidecar.c_str(), error);
+		if (!written) fprintf(stderr, "%s\n", error.c_str());
+		delete p;
+		delete pars;
+		return written ? 0 : 1;
 	}
 
-	if (!pars->CH) {
-		std::cout << "No constructive heuristic has been defined." << std::endl;
-		return 1;
+	if (verbose) print_problem(p);
+
+	// The trace is written as CSV, a line as soon as a new best value is found
+	std::ofstream trace_file;
+	if (pars->trace_file) {
+		const bool    to_stderr = strcmp(pars->trace_file, "-") == 0;
+		std::ostream& out       = to_stderr ? std::cerr : trace_file;
+		if (!to_stderr) trace_file.open(pars->trace_file);
+		out << "elapsed_ms,value,iterations,evaluations,gap" << std::endl;
+		pars->on_incumbent = [&out](const incumbent& update) {
+			out << update.elapsed.count() << ',' << update.value << ',' << update.iterations << ','
+			    << update.evaluations << ',';
+			if (!std::isnan(update.gap)) out << update.gap;
+			out << std::endl;
+		};
 	}
 
-	auto s = Solution(*p, pars->CH);
-	if (verbose) std::cout << "After applying the constructive heuristic:" << std::endl;
-	std::cout << s;
+	// The telemetry goes to stderr, one JSON line per report, so the output stays the same
+	if (pars->stats)
+		pars->on_stats = [](const telemetry_report& report) {
+			write_json(std::cerr, report) << std::endl;
+		};
 
-	if (pars->II) {
-		(s.*pars->II)(*p, pars->CH);
-		if (verbose) std::cout << "After applying the iterative improvement algorithm:";
-		std::cout << std::endl << s;
+	int code = 0;
+	if (auto r = solve(*p, *pars)) {
+		print(*r, *pars);
+		if (r->telemetry) write_json(std::cerr, *r->telemetry) << std::endl;
+	} else {
+		if (std::holds_alternative<std::monostate>(pars->SLA) &&
+		    std::holds_alternative<std::monostate>(pars->CH))
+			std::cout << "No constructive heuristic has been defined." << std::endl;
+		else
+			fprintf(stderr, "invalid options of the algorithm\n");
+		code = 1;
 	}
 
 	delete p;
 	delete pars;
 
-	return 0;
+	return code;
 }
@@ -19,68 +19,353 @@
  ***************************************************************************/
 
 #include "mkpio.h"
+#include "util.h"
 
-FILE* open_file(char* filename) {
-	FILE* input_file;
-//	printf("\nOpening instance file %s\n\n", filename);
-	if ((input_file = fopen(filename, "r")) == nullptr) {
-		fprintf(stderr, "error opening input file %s\n", filename);
-		exit(1);
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * Map a file into memory
+ * @param filename
+ * @param error
+ */
+mapped_file::mapped_file(const char* filename, std::string& error):
+	filename(filename), bytes(nullptr), length(0) {
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0) {
+		error = std::string("error opening input file ") + filename;
+		return;
+	}
+
+	struct stat st {};
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		close(fd);
+		error = std::string("error reading input file ") + filename + ": empty or unreadable file";
+		return;
+	}
+
+	void* map = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		error = std::string("error mapping input file ") + filename;
+		return;
+	}
+	madvise(map, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+	bytes  = static_cast<const char*>(map);
+	length = static_cast<size_t>(st.st_size);
+}
+
+mapped_file::~mapped_file() {
+	if (bytes) munmap(const_cast<char*>(bytes), length);
+}
+
+/**
+ * Record a parse error with its line and column and stop the scanner, only the first error is kept
+ * @param what the value that was being read
+ * @param reason
+ * @return 0, the value of a failed read
+ */
+int int_scanner::fail(const char* what, const char* reason) {
+	if (!failure.empty()) return 0;
+
+	size_t line = 1, column = 1;
+	for (const char* c = file.data(); c < cur; ++c) {
+		if (*c == '\n') {
+			++line;
+			column = 1;
+		} else {
+			++column;
+		}
 	}
 
-	return (input_file);
+	failure = std::string("error reading input file ") + file.name() + ":" +
+	          std::to_string(line) + ":" + std::to_string(column) + ": " + reason +
+	          " while reading " + what;
+	cur     = end;
+	return 0;
 }
 
-void close_file(FILE* input_file) { fclose(input_file); }
+/**
+ * Round an offset up to the 64 byte section alignment
+ * @param offset
+ * @return
+ */
+static uint64_t align(uint64_t offset) { return (offset + 63) & ~uint64_t{ 63 }; }
 
-int* read_problem_data(FILE* input_file) {
-	int* problem_data = static_cast<int*>(malloc(3 * sizeof(int)));
-	fscanf(input_file, "%d", &problem_data[0]);
-	fscanf(input_file, "%d", &problem_data[1]);
-	fscanf(input_file, "%d", &problem_data[2]);
-	// printf("%d %d %d\n", problem_data[0], problem_data[1], problem_data[2]);
-	return (problem_data);
+/**
+ * The end of a section of rows x length elements that starts at an offset
+ * @param offset
+ * @param rows
+ * @param length
+ * @param element the size of an element in bytes
+ * @param end set to the end of the section
+ * @return false if the end does not fit in 64 bits
+ */
+static bool section_end(uint64_t offset, uint64_t rows, uint64_t length, uint64_t element,
+                        uint64_t& end) {
+	return !__builtin_mul_overflow(rows, length, &end) &&
+	       !__builtin_mul_overflow(end, element, &end) &&
+	       !__builtin_add_overflow(offset, end, &end);
 }
 
-int* read_profits(FILE* input_file, int n) {
-	int  i;
-	int* profits = static_cast<int*>(malloc(n * sizeof(int)));
+/**
+ * Allocate a zeroed image for a problem of n items and m knapsacks and fill its header
+ * @param n
+ * @param m
+ * @param best_known
+ * @return the image, nullptr if its size overflows or it cannot be allocated
+ */
+static std::shared_ptr<mkpb_header> allocate_image(uint64_t n, uint64_t m, int32_t best_known) {
+	const uint64_t stride   = padded(m);
+	const uint64_t n_stride = padded(n);
+
+	mkpb_header header{};
+	memcpy(header.magic, "MKPB", 4);
+	header.version    = mkpb_version;
+	header.n          = n;
+	header.m          = m;
+	header.best_known = best_known;
+	header.stride     = stride;
+	header.n_stride   = n_stride;
+
+	// Every section starts at the aligned end of the previous one
+	bool       valid = true;
+	const auto next  = [&](uint64_t offset, uint64_t rows, uint64_t length, uint64_t element) {
+		uint64_t end = 0;
+		valid = valid && section_end(offset, rows, length, element, end) && end <= ~uint64_t{ 63 };
+		return valid ? align(end) : 0;
+	};
+	header.profits       = align(sizeof(mkpb_header));
+	header.constraints   = next(header.profits, n, 1, sizeof(int));
+	header.constraints_t = next(header.constraints, n, stride, sizeof(int));
+	header.capacities    = next(header.constraints_t, m, n_stride, sizeof(int));
+	header.toyoda        = next(header.capacities, stride, 1, sizeof(int));
+	header.toyoda_t      = next(header.toyoda, n, stride, sizeof(double));
+	header.size          = next(header.toyoda_t, m, n_stride, sizeof(double));
+	if (!valid) return nullptr;
+
+	void* memory = aligned_alloc(64, header.size);
+	if (!memory) return nullptr;
+	memset(memory, 0, header.size);
+	memcpy(memory, &header, sizeof(header));
+
+	return { static_cast<mkpb_header*>(memory), free };
+}
+
+/**
+ * Parse an OR-library instance: n m best_known, n profits, m rows of n constraint values and m
+ * capacities. All values are parsed straight into the sections of a new image.
+ * @param filename
+ * @param error set to the reason the instance could not be parsed
+ * @return the image, without the Toyoda matrix, or nullptr
+ */
+std::shared_ptr<mkpb_header> parse_instance(const char* filename, std::string& error) {
+	mapped_file file(filename, error);
+	if (!file) return nullptr;
+	int_scanner scanner(file);
+
+	const int n          = scanner.next("the number of items");
+	const int m          = scanner.next("the number of knapsacks");
+	const int best_known = scanner.next("the best known value");
+
+	if (!scanner.error().empty()) {
+		error = scanner.error();
+		return nullptr;
+	}
+	if (n <= 0 || m <= 0) {
+		error = std::string("error reading input file ") + filename + ": invalid problem size " +
+		        std::to_string(n) + " x " + std::to_string(m);
+		return nullptr;
+	}
+
+	// Every value takes at least a digit and a separator, a file too small for all of them is
+	// rejected before its image is allocated
+	const uint64_t values = uint64_t{ static_cast<uint32_t>(n) } * static_cast<uint32_t>(m) +
+	                        static_cast<uint32_t>(n) + static_cast<uint32_t>(m) + 3;
+	if (2 * values - 1 > file.size()) {
+		error = std::string("error reading input file ") + filename + ": the file is too small " +
+		        "for a problem of " + std::to_string(n) + " x " + std::to_string(m);
+		return nullptr;
+	}
+
+	auto image = allocate_image(n, m, best_known);
+	if (!image) {
+		error = "error allocating a problem of " + std::to_string(n) + " x " + std::to_string(m);
+		return nullptr;
+	}
+
+	// A failed read stops the loops, so a truncated file is rejected without filling the rest
+	const auto reading = [&] { return scanner.error().empty(); };
+
+	int* profits = image->section<int>(image->profits);
+	for (int j = 0; j < n && reading(); ++j) profits[j] = scanner.next("the profits");
+
+	// The file lists the constraints resource by resource, which is the resource-major layout
+	int* constraints   = image->section<int>(image->constraints);
+	int* constraints_t = image->section<int>(image->constraints_t);
+	for (size_t i = 0; i < static_cast<size_t>(m) && reading(); ++i)
+		for (size_t j = 0; j < static_cast<size_t>(n) && reading(); ++j)
+			constraints[j * image->stride + i] = constraints_t[i * image->n_stride + j] =
+				scanner.next("the constraints");
 
-	for (i = 0; i < n; i++) { fscanf(input_file, "%d", &profits[i]); }
+	int* capacities = image->section<int>(image->capacities);
+	for (int i = 0; i < m && reading(); ++i) capacities[i] = scanner.next("the capacities");
 
-	/*for (i = 0 ; i < n ; i++) {
-	  printf("%d ", profits[i]);
+	if (!reading()) {
+		error = scanner.error();
+		return nullptr;
 	}
-	printf("\n\n");*/
 
-	return (profits);
+	// The Toyoda matrix divides by the capacities, like build_problem only positive ones are valid
+	for (int i = 0; i < m; ++i) {
+		if (capacities[i] <= 0) {
+			error = std::string("error reading input file ") + filename + ": invalid capacity " +
+			        std::to_string(capacities[i]) + " of knapsack " + std::to_string(i + 1);
+			return nullptr;
+		}
+	}
+	return image;
+}
+
+/**
+ * Copy an instance from memory into a new image, with the same layout as an OR-library file
+ * @param n the number of items
+ * @param m the number of knapsacks
+ * @param profits n profits
+ * @param constraints m rows of n constraint values
+ * @param capacities m capacities
+ * @param best_known
+ * @return the image, without the Toyoda matrix, or nullptr if it cannot be allocated
+ */
+std::shared_ptr<mkpb_header> copy_instance(uint32_t n, uint32_t m, const int* profits,
+                                           const int* constraints, const int* capacities,
+                                           int32_t best_known) {
+	auto image = allocate_image(n, m, best_known);
+	if (!image) return nullptr;
+
+	std::copy_n(profits, n, image->section<int>(image->profits));
+
+	int* item_major     = image->section<int>(image->constraints);
+	int* resource_major = image->section<int>(image->constraints_t);
+	for (size_t i = 0; i < m; ++i)
+		for (size_t j = 0; j < n; ++j)
+			item_major[j * image->stride + i] = resource_major[i * image->n_stride + j] =
+				constraints[i * n + j];
+
+	std::copy_n(capacities, m, image->section<int>(image->capacities));
+
+	return image;
+}
+
+/**
+ * Check the header of a mapped image against the size of the file
+ * @param header
+ * @param size
+ * @return
+ */
+static bool valid_image(const mkpb_header& header, size_t size) {
+	if (memcmp(header.magic, "MKPB", 4) != 0 || header.version != mkpb_version) return false;
+	if (header.n == 0 || header.m == 0 || header.size != size) return false;
+
+	if (header.stride != padded(header.m) || header.n_stride != padded(header.n)) return false;
+
+	// The sections must lie inside the file, a header whose sections overflow is invalid
+	const uint64_t n = header.n, m = header.m, stride = header.stride, n_stride = header.n_stride;
+	const auto     inside = [&](uint64_t offset, uint64_t rows, uint64_t length, uint64_t element) {
+		uint64_t end = 0;
+		return offset % 64 == 0 && section_end(offset, rows, length, element, end) && end <= size;
+	};
+	return inside(header.profits, n, 1, sizeof(int)) &&
+	       inside(header.constraints, n, stride, sizeof(int)) &&
+	       inside(header.constraints_t, m, n_stride, sizeof(int)) &&
+	       inside(header.capacities, stride, 1, sizeof(int)) &&
+	       inside(header.toyoda, n, stride, sizeof(double)) &&
+	       inside(header.toyoda_t, m, n_stride, sizeof(double));
 }
 
-int** read_constraints(FILE* input_file, int m, int n) {
-	int   i, j;
-	int** constraints = static_cast<int**>(malloc(n * sizeof(int*)));
-	for (i = 0; i < n; i++) { constraints[i] = static_cast<int*>(malloc(m * sizeof(int))); }
+/**
+ * Map a binary image. The mapping stays alive as long as the returned pointer.
+ * @param filename
+ * @param error set to the reason the image could not be mapped
+ * @return the image or nullptr
+ */
+std::shared_ptr<const mkpb_header> map_image(const char* filename, std::string& error) {
+	auto file = std::make_shared<mapped_file>(filename, error);
+	if (!*file) return nullptr;
+	auto header = reinterpret_cast<const mkpb_header*>(file->data());
 
-	for (i = 0; i < m; i++) {
-		for (j = 0; j < n; j++) { fscanf(input_file, "%d", &constraints[j][i]); }
+	if (file->size() < sizeof(mkpb_header) || !valid_image(*header, file->size())) {
+		error = std::string("error reading input file ") + filename +
+		        ": invalid or incompatible binary image";
+		return nullptr;
 	}
 
-	/*for (i = 0 ; i < m ; i++) {
-	  for (j = 0 ; j < n ; j++) {
-	    printf("%d ", constraints[i][j]);
-	  }
-	  printf("\n");
+	return { file, header };
+}
+
+/**
+ * Write an image to a temporary file of its own in the same directory and rename it, so readers
+ * never see a partial image and concurrent writers of the same image never share a file
+ * @param image
+ * @param filename
+ * @param error
+ * @return success
+ */
+bool write_image(const mkpb_header& image, const char* filename, std::string& error) {
+	std::string tmp    = std::string(filename) + ".XXXXXX";
+	const auto  failed = [&] {
+		error = std::string("error writing binary image ") + filename;
+		return false;
+	};
+
+	const int fd     = mkstemp(tmp.data());
+	FILE*     output = fd < 0 ? nullptr : fdopen(fd, "wb");
+	if (!output) {
+		if (fd >= 0) {
+			close(fd);
+			unlink(tmp.c_str());
+		}
+		return failed();
 	}
-	printf("\n");*/
 
-	return (constraints);
+	// mkstemp creates the file readable by its owner only
+	const bool written = fchmod(fd, 0644) == 0 &&
+	                     fwrite(&image, 1, image.size, output) == image.size;
+	if (fclose(output) != 0 || !written || rename(tmp.c_str(), filename) != 0) {
+		unlink(tmp.c_str());
+		return failed();
+	}
+	return true;
 }
 
-int* read_capacities(FILE* input_file, int m) {
-	int  i;
-	int* capacities = static_cast<int*>(malloc(m * sizeof(int)));
+/**
+ * The path of the binary cache next to an instance: the .dat extension is replaced by .mkpb.
+ * A binary image is its own sidecar.
+ * @param filename
+ * @return
+ */
+std::string sidecar_path(const char* filename) {
+	std::string path(filename);
+	if (path.size() > 5 && path.compare(path.size() - 5, 5, ".mkpb") == 0) return path;
+	if (path.size() > 4 && path.compare(path.size() - 4, 4, ".dat") == 0)
+		path.resize(path.size() - 4);
+	return path + ".mkpb";
+}
 
-	for (i = 0; i < m; i++) { fscanf(input_file, "%d", &capacities[i]); }
+/**
+ * Check if a sidecar exists and was modified after the instance
+ * @param filename the instance
+ * @param sidecar
+ * @return
+ */
+bool sidecar_fresh(const char* filename, const std::string& sidecar) {
+	struct stat instance {}, cache {};
+	if (stat(filename, &instance) != 0 || stat(sidecar.c_str(), &cache) != 0) return false;
+	if (static_cast<size_t>(cache.st_size) < sizeof(mkpb_header)) return false;
 
-	return (capacities);
+	if (cache.st_mtim.tv_sec != instance.st_mtim.tv_sec)
+		return cache.st_mtim.tv_sec > instance.st_mtim.tv_sec;
+	return cache.st_mtim.tv_nsec > instance.st_mtim.tv_nsec;
 }
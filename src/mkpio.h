@@ -24,21 +24,160 @@
 #include <cassert>
 #include <climits>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
+#include <memory>
+#include <string>
 
-FILE* open_file(char* filename);
+/**
+ * Read-only memory mapping of a complete file
+ */
+class mapped_file {
+	const char* filename;
+	const char* bytes;
+	size_t      length;
 
-void close_file(FILE* input_file);
+public:
+	/**
+	 * Map a file, the mapping is empty when it fails
+	 * @param filename
+	 * @param error set to the reason the file could not be mapped
+	 */
+	mapped_file(const char* filename, std::string& error);
+	~mapped_file();
 
-int* read_problem_data(FILE* input_file);
+	mapped_file(const mapped_file&) = delete;
+	mapped_file& operator=(const mapped_file&) = delete;
 
-int* read_profits(FILE* input_file, int n);
+	explicit operator bool() const { return bytes; }
 
-int** read_constraints(FILE* input_file, int m, int n);
+	[[nodiscard]] const char* name() const { return filename; }
+	[[nodiscard]] const char* data() const { return bytes; }
+	[[nodiscard]] size_t      size() const { return length; }
+};
 
-int* read_capacities(FILE* input_file, int m);
+/**
+ * Integer scanner over a memory buffer that reports truncated or malformed input with its position.
+ * The first error stops the scanner: every later read returns 0 and the error is kept.
+ */
+class int_scanner {
+	const mapped_file& file;
+	const char*        cur;
+	const char*        end;
+	std::string        failure;
+
+	int fail(const char* what, const char* reason);
+
+public:
+	explicit int_scanner(const mapped_file& file):
+		file(file), cur(file.data()), end(file.data() + file.size()) {}
+
+	/**
+	 * @return the first error, empty if there was none
+	 */
+	[[nodiscard]] const std::string& error() const { return failure; }
+
+	/**
+	 * Read the next whitespace separated integer
+	 * @param what a description of the value used in error messages
+	 * @return the integer, 0 after an error
+	 */
+	int next(const char* what) {
+		// Skip whitespace
+		while (cur < end && (*cur == ' ' || static_cast<unsigned char>(*cur - '\t') < 5)) ++cur;
+		if (cur == end) return fail(what, "unexpected end of file");
+
+		const bool negative = *cur == '-';
+		cur += negative;
+
+		// Accumulate the magnitude unsigned, a digit is exactly a byte for which c - '0' < 10
+		const char*        start = cur;
+		unsigned long long value = 0;
+		unsigned           digit;
+		while (cur < end && (digit = static_cast<unsigned char>(*cur - '0')) < 10) {
+			value = value * 10 + digit;
+			++cur;
+		}
+
+		// The magnitude of INT_MIN is one more than INT_MAX
+		const unsigned long long limit = static_cast<unsigned long long>(INT_MAX) + negative;
+		if (cur == start) return fail(what, "expected an integer");
+		if (cur - start > 10 || value > limit) return fail(what, "integer out of range");
+		if (cur < end && *cur != ' ' && static_cast<unsigned char>(*cur - '\t') >= 5)
+			return fail(what, "malformed integer");
+
+		const auto magnitude = static_cast<long long>(value);
+		return static_cast<int>(negative ? -magnitude : magnitude);
+	}
+};
+
+/**
+ * Header of a binary instance image (.mkpb). The header is followed by the profits, the constraint
+ * matrix both item-major and resource-major, the capacities and the rescaled Toyoda matrix A both
+ * item-major and resource-major. Every section and every matrix row starts at a 64 byte aligned
+ * offset and all padding is zero, so a mapped file can be used in place without copies.
+ */
+struct mkpb_header {
+	char     magic[4];         // "MKPB"
+	uint32_t version;          // mkpb_version
+	uint32_t n;                // number of items
+	uint32_t m;                // number of knapsacks
+	int32_t  best_known;       // best known value, 0 if unknown
+	uint32_t stride;           // padded row length of the item-major matrices
+	uint32_t n_stride;         // padded row length of the resource-major matrices
+	uint32_t reserved;         // always 0
+	uint64_t profits;          // int[n] offset
+	uint64_t constraints;      // int[n][stride] offset
+	uint64_t constraints_t;    // int[m][n_stride] offset
+	uint64_t capacities;       // int[stride] offset
+	uint64_t toyoda;           // double[n][stride] offset
+	uint64_t toyoda_t;         // double[m][n_stride] offset
+	uint64_t size;             // total size of the image in bytes
+	uint64_t unused[5];        // always 0
+
+	/**
+	 * Access a section of the image
+	 * @tparam T the element type
+	 * @param offset the section offset
+	 * @return a pointer to the first element
+	 */
+	template<class T> T* section(uint64_t offset) {
+		return reinterpret_cast<T*>(reinterpret_cast<char*>(this) + offset);
+	}
+
+	template<class T> const T* section(uint64_t offset) const {
+		return reinterpret_cast<const T*>(reinterpret_cast<const char*>(this) + offset);
+	}
+};
+
+static_assert(sizeof(mkpb_header) == 128);
+
+constexpr uint32_t mkpb_version = 2;
+
+// Parse an OR-library instance file into a new image, the Toyoda matrices are left zeroed.
+// Returns nullptr and sets the error for an unreadable or malformed file.
+std::shared_ptr<mkpb_header> parse_instance(const char* filename, std::string& error);
+
+// Copy an instance from memory into a new image, the Toyoda matrices are left zeroed. Returns
+// nullptr if the image cannot be allocated.
+std::shared_ptr<mkpb_header> copy_instance(uint32_t n, uint32_t m, const int* profits,
+                                           const int* constraints, const int* capacities,
+                                           int32_t best_known);
+
+// Map a binary image in place, returns nullptr and sets the error for an invalid image
+std::shared_ptr<const mkpb_header> map_image(const char* filename, std::string& error);
+
+// Write an image atomically to a file, returns false and sets the error on failure
+bool write_image(const mkpb_header& image, const char* filename, std::string& error);
+
+// The path of the binary cache next to an instance file
+std::string sidecar_path(const char* filename);
+
+// Check if the sidecar exists and is newer than the instance file
+bool sidecar_fresh(const char* filename, const std::string& sidecar);
 
 #endif
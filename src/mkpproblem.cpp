@@ -19,24 +19,48 @@
  ***************************************************************************/
 
 #include "mkpproblem.h"
+#include "rng.h"
+
+#include <numeric>
 
 /**
- * Create a problem and also initialize the rescaled constraint value matrix A used in Toyoda
- * @param n
- * @param m
- * @param b
- * @param profits
- * @param constraints
- * @param capacities
+ * Create a problem from its image without copying any of the data
+ * @param image
  */
-problem::problem(int n, int m, int b, int* profits, int** constraints, int* capacities):
-	n(n), m(m), best_known(b), profits(profits), constraints(constraints), capacities(capacities),
-	A(n, m) {
-	for (size_t i = 0; i < static_cast<size_t>(n); ++i)
-		for (size_t j = 0; j < static_cast<size_t>(m); ++j)
-			A(i, j) = static_cast<double>(constraints[i][j]) / static_cast<double>(capacities[j]);
+problem::problem(std::shared_ptr<const mkpb_header> image):
+	n(static_cast<int>(image->n)), m(static_cast<int>(image->m)), best_known(image->best_known),
+	profits(image->section<int>(image->profits)),
+	constraints(image->section<int>(image->constraints), image->n, image->m, image->stride),
+	constraints_t(image->section<int>(image->constraints_t), image->m, image->n, image->n_stride),
+	capacities(image->section<int>(image->capacities)),
+	A(image->section<double>(image->toyoda), image->n, image->m, image->stride),
+	A_t(image->section<double>(image->toyoda_t), image->m, image->n, image->n_stride),
+	greedy_order(image->n), zobrist(image->n), image(std::move(image)) {
+	std::iota(greedy_order.begin(), greedy_order.end(), 0);
+	std::sort(greedy_order.begin(), greedy_order.end(),
+	          [this](size_t a, size_t b) { return profits[a] > profits[b]; });
+
+	// The keys are independent of the seed of the run
+	rng keys(0x5eed);
+	for (auto& key : zobrist) key = keys();
 }
 
+/**
+ * Initialize the rescaled constraint value matrices A and A^T used in Toyoda
+ * @param image
+ */
+static void rescale(mkpb_header& image) {
+	const int* constraints = image.section<int>(image.constraints);
+	const int* capacities  = image.section<int>(image.capacities);
+	double*    A           = image.section<double>(image.toyoda);
+	double*    A_t         = image.section<double>(image.toyoda_t);
+
+	for (size_t i = 0; i < image.n; ++i)
+		for (size_t j = 0; j < image.m; ++j)
+			A[i * image.stride + j] = A_t[j * image.n_stride + i] =
+				static_cast<double>(constraints[i * image.stride + j]) /
+				static_cast<double>(capacities[j]);
+}
 
 void print_problem(problem* p) {
 	int i, j;
@@ -58,23 +82,34 @@ void print_problem(problem* p) {
 	printf("\n");
 }
 
-problem* read_problem(char* filename) {
-	FILE* input_file = open_file(filename);
-
-	int* problem_data = read_problem_data(input_file);
-	int  n = problem_data[0], m = problem_data[1], b = problem_data[2];
-
-	int*  profits     = read_profits(input_file, n);
-	int** constraints = read_constraints(input_file, m, n);
-	int*  capacities  = read_capacities(input_file, m);
-
-	close_file(input_file);
-
-	problem* p = new problem(n, m, b, profits, constraints, capacities);
-
-	free(problem_data);
+/**
+ * Read a problem from an OR-library instance or a binary image (.mkpb).
+ * A binary sidecar next to the instance is used instead when it is newer than the instance and
+ * valid, the instance is parsed otherwise.
+ * @param filename
+ * @param error set to the reason the problem could not be read, if not nullptr
+ * @return the problem, or nullptr for a missing, malformed or invalid file
+ */
+problem* read_problem(const char* filename, std::string* error) {
+	std::shared_ptr<const mkpb_header> image;
+	std::string                        reason;
+
+	std::string sidecar = sidecar_path(filename);
+	if (sidecar == filename) image = map_image(filename, reason);
+	else {
+		if (sidecar_fresh(filename, sidecar)) image = map_image(sidecar.c_str(), reason);
+		if (!image) {
+			auto parsed = parse_instance(filename, reason);
+			if (parsed) rescale(*parsed);
+			image = std::move(parsed);
+		}
+	}
 
-	return (p);
+	if (!image) {
+		if (error) *error = reason;
+		return nullptr;
+	}
+	return new problem(std::move(image));
 }
 
 unsigned int problem::runtime() const { return n * m / 10; }
@@ -90,6 +125,33 @@ double problem::initial_temperature() const {
 	return (min - max) * 0.1 / std::log(0.99);
 }
 
-double problem::cooling_factor() const {
-	return std::pow(std::log(0.99) / std::log(0.02), 1.0 / (runtime() * 1000));
+double problem::cooling_factor() const { return cooling_factor(runtime() * 1000.0); }
+
+double problem::cooling_factor(double milliseconds) const {
+	return std::pow(std::log(0.99) / std::log(0.02), 1.0 / milliseconds);
+}
+
+/**
+ * Build a problem from memory, the data is copied in the same layout as an OR-library instance
+ * @param n the number of items
+ * @param m the number of knapsacks
+ * @param profits n non-negative profits
+ * @param constraints m rows of n non-negative constraint values
+ * @param capacities m positive capacities
+ * @param best_known the best known value, 0 if unknown
+ * @return the problem, or nullptr for an invalid problem or one that cannot be allocated
+ */
+problem* build_problem(int n, int m, const int* profits, const int* constraints,
+                       const int* capacities, int best_known) {
+	if (n <= 0 || m <= 0 || !profits || !constraints || !capacities) return nullptr;
+	if (std::any_of(profits, profits + n, [](int v) { return v < 0; }) ||
+	    std::any_of(constraints, constraints + static_cast<size_t>(n) * m,
+	                [](int v) { return v < 0; }) ||
+	    std::any_of(capacities, capacities + m, [](int v) { return v <= 0; }))
+		return nullptr;
+
+	auto image = copy_instance(n, m, profits, constraints, capacities, best_known);
+	if (!image) return nullptr;
+	rescale(*image);
+	return new problem(std::move(image));
 }
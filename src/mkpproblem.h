@@ -28,23 +28,37 @@ struct problem {
 	int            n;
 	int            m;
 	int            best_known;
-	int*           profits;
-	int**          constraints;
-	int*           capacities;
-	// The rescaled constraint matrix used in Toyoda
+	const int*     profits;
+	// The constraint matrix, item-major: constraints[item][resource]
+	Matrix<int>    constraints;
+	// The constraint matrix, resource-major: constraints_t[resource][item]
+	Matrix<int>    constraints_t;
+	// The capacities, padded with zeros to the row stride of constraints
+	const int*     capacities;
+	// The rescaled constraint matrix used in Toyoda, item-major and resource-major
 	Matrix<double> A;
+	Matrix<double> A_t;
+	// The items sorted by decreasing profit, the insertion order of the greedy heuristic
+	Vector<size_t>   greedy_order;
+	// A random key per item, the hash of a solution is the XOR of the keys of its items
+	Vector<uint64_t> zobrist;
+	// The binary image that owns all the problem data
+	std::shared_ptr<const mkpb_header> image;
 
-	problem(int n, int m, int b, int* profits, int** constraints, int* capacities);
+	explicit problem(std::shared_ptr<const mkpb_header> image);
 
 	[[nodiscard]] unsigned int runtime() const;
 	[[nodiscard]] double       initial_temperature() const;
 	[[nodiscard]] double       cooling_factor() const;
+	// the cooling factor of a geometric schedule over the given milliseconds
+	[[nodiscard]] double       cooling_factor(double milliseconds) const;
 };
 
-void destroy_problem(problem* p);
-
 void print_problem(problem* p);
 
-problem* read_problem(char* filename);
+problem* read_problem(const char* filename, std::string* error = nullptr);
+
+problem* build_problem(int n, int m, const int* profits, const int* constraints,
+                       const int* capacities, int best_known = 0);
 
 #endif
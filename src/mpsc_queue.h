@@ -0,0 +1,92 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#ifndef MKP_MPSC_QUEUE_H
+#define MKP_MPSC_QUEUE_H
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <type_traits>
+
+/**
+ * Bounded lock-free ring buffer for any number of producer threads and one consumer thread.
+ * Every cell carries a sequence number that tells whose turn it is: a producer claims a cell by
+ * advancing the shared tail and publishes it by bumping its sequence, the consumer releases it
+ * for the next lap. Neither side ever blocks: a push to a full queue and a pop from an empty queue
+ * fail instead.
+ * @tparam T trivially copyable, so a cell can be overwritten without destroying it
+ */
+template<class T> class mpsc_queue {
+	static_assert(std::is_trivially_copyable_v<T>);
+
+	struct cell {
+		std::atomic<size_t> sequence;
+		T                   value;
+	};
+
+	std::unique_ptr<cell[]> cells;
+	size_t                  mask;
+
+	// The next cell to push, claimed by the producers
+	alignas(64) std::atomic<size_t> tail = 0;
+	// The next cell to pop, touched by the consumer only
+	alignas(64) size_t head = 0;
+
+public:
+	/**
+	 * @param capacity rounded up to a power of two
+	 */
+	explicit mpsc_queue(size_t capacity):
+		cells(new cell[std::bit_ceil(capacity)]), mask(std::bit_ceil(capacity) - 1) {
+		for (size_t i = 0; i <= mask; ++i) cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	mpsc_queue(const mpsc_queue&)            = delete;
+	mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+	/**
+	 * Push an element, can be called by any thread
+	 * @param value
+	 * @return false if the queue is full, the value is then dropped
+	 */
+	bool try_push(const T& value) {
+		size_t t = tail.load(std::memory_order_relaxed);
+		for (;;) {
+			cell&        c        = cells[t & mask];
+			const size_t sequence = c.sequence.load(std::memory_order_acquire);
+			if (sequence == t) {
+				// The cell is free in this lap, claim it
+				if (tail.compare_exchange_weak(t, t + 1, std::memory_order_relaxed)) {
+					c.value = value;
+					c.sequence.store(t + 1, std::memory_order_release);
+					return true;
+				}
+			} else if (sequence < t) {
+				// The consumer has not released the cell of the previous lap
+				return false;
+			} else {
+				// Another producer claimed the cell first
+				t = tail.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	/**
+	 * Pop an element, called by the consumer only
+	 * @return the oldest published element, or nothing if the queue is empty
+	 */
+	std::optional<T> try_pop() {
+		cell& c = cells[head & mask];
+		if (c.sequence.load(std::memory_order_acquire) != head + 1) return std::nullopt;
+		T value = c.value;
+		c.sequence.store(head + mask + 1, std::memory_order_release);
+		++head;
+		return value;
+	}
+};
+
+#endif    // MKP_MPSC_QUEUE_H
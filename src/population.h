@@ -0,0 +1,143 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#ifndef MKP_POPULATION_H
+#define MKP_POPULATION_H
+
+#include "solution.h"
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+
+/**
+ * Population of the memetic algorithm with O(1) duplicate detection and O(log N) replacement of
+ * the worst individual. The individuals are indexed by their Zobrist hash and kept in an indexed
+ * min-heap on their value, ties are broken by the lowest index.
+ * @tparam W
+ */
+template<size_t W> class Population {
+	std::vector<Solution<W>> individuals;
+	// Hash of an individual to its index, hashes can collide so every match is compared in full
+	std::unordered_multimap<uint64_t, size_t> index;
+	// Min-heap of individual indices and the position of every individual in it
+	Vector<size_t> heap;
+	Vector<size_t> slot;
+
+	/**
+	 * @param a
+	 * @param b
+	 * @return whether individual a is worse than individual b
+	 */
+	[[nodiscard]] bool worse(size_t a, size_t b) const {
+		const auto& x = individuals[a];
+		const auto& y = individuals[b];
+		return x < y || (!(y < x) && a < b);
+	}
+
+	void swap(size_t i, size_t j) {
+		std::swap(heap[i], heap[j]);
+		slot[heap[i]] = i;
+		slot[heap[j]] = j;
+	}
+
+	void sift_up(size_t i) {
+		for (; i > 0 && worse(heap[i], heap[(i - 1) / 2]); i = (i - 1) / 2) swap(i, (i - 1) / 2);
+	}
+
+	void sift_down(size_t i) {
+		while (true) {
+			size_t smallest = i;
+			for (size_t child = 2 * i + 1; child <= 2 * i + 2 && child < heap.size(); ++child)
+				if (worse(heap[child], heap[smallest])) smallest = child;
+			if (smallest == i) return;
+			swap(i, smallest);
+			i = smallest;
+		}
+	}
+
+	void erase_hash(size_t i) {
+		auto [begin, end] = index.equal_range(individuals[i].hash());
+		for (auto it = begin; it != end; ++it) {
+			if (it->second == i) {
+				index.erase(it);
+				return;
+			}
+		}
+	}
+
+public:
+	// tests/population_test.cpp checks the heap and the hash index through it
+	friend struct kernel_access;
+
+	Population() = default;
+
+	/**
+	 * Add an individual, duplicates are allowed
+	 * @param s
+	 */
+	void push(Solution<W> s) {
+		const size_t i = individuals.size();
+		index.emplace(s.hash(), i);
+		individuals.push_back(std::move(s));
+		heap.push_back(i);
+		slot.push_back(heap.size() - 1);
+		sift_up(heap.size() - 1);
+	}
+
+	[[nodiscard]] size_t size() const { return individuals.size(); }
+
+	const Solution<W>& operator[](size_t i) const { return individuals[i]; }
+
+	/**
+	 * @param s
+	 * @return whether an individual equal to s is in the population
+	 */
+	[[nodiscard]] bool contains(const Solution<W>& s) const {
+		auto [begin, end] = index.equal_range(s.hash());
+		for (auto it = begin; it != end; ++it)
+			if (individuals[it->second] == s) return true;
+		return false;
+	}
+
+	/**
+	 * @return the individual with the lowest value, the first one on ties
+	 */
+	[[nodiscard]] const Solution<W>& worst() const { return individuals[heap.front()]; }
+
+	/**
+	 * @return the individual with the highest value, the first one on ties
+	 */
+	[[nodiscard]] const Solution<W>& best() const {
+		return *std::max_element(individuals.begin(), individuals.end());
+	}
+
+	/**
+	 * @param k
+	 * @return the indices of the k best individuals, best first and the first one on ties
+	 */
+	[[nodiscard]] Vector<size_t> elite(size_t k) const {
+		Vector<size_t> indices(individuals.size());
+		std::iota(indices.begin(), indices.end(), 0);
+		k = std::min(k, indices.size());
+		std::partial_sort(indices.begin(), indices.begin() + static_cast<ptrdiff_t>(k),
+		                  indices.end(), [this](size_t a, size_t b) { return worse(b, a); });
+		indices.resize(k);
+		return indices;
+	}
+
+	/**
+	 * Replace the worst individual
+	 * @param s
+	 */
+	void replace_worst(Solution<W> s) {
+		const size_t i = heap.front();
+		erase_hash(i);
+		index.emplace(s.hash(), i);
+		individuals[i] = std::move(s);
+		sift_down(0);
+	}
+};
+
+#endif    // MKP_POPULATION_H
@@ -0,0 +1,35 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "rng.h"
+
+rng::rng(uint64_t seed) {
+	for (auto& word : state) {
+		uint64_t z = (seed += 0x9e3779b97f4a7c15);
+		z          = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+		z          = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+		word       = z ^ (z >> 31);
+	}
+}
+
+void rng::jump() {
+	static constexpr uint64_t polynomial[] = { 0x180ec6d33cfd0aba, 0xd5a61266f0c9392c,
+		                                       0xa9582618e03fc9aa, 0x39abdc4529b1661c };
+
+	uint64_t jumped[4] = {};
+	for (auto word : polynomial) {
+		for (int bit = 0; bit < 64; ++bit) {
+			if (word & uint64_t{ 1 } << bit)
+				for (int i = 0; i < 4; ++i) jumped[i] ^= state[i];
+			(*this)();
+		}
+	}
+
+	for (int i = 0; i < 4; ++i) state[i] = jumped[i];
+}
+
+rng& generator() {
+	thread_local rng stream;
+	return stream;
+}
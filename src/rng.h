@@ -0,0 +1,108 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#ifndef MKP_RNG_H
+#define MKP_RNG_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * xoshiro256** pseudo random number generator with jump-ahead for independent streams.
+ * It satisfies UniformRandomBitGenerator so it can also drive the standard distributions.
+ */
+class rng {
+	uint64_t state[4];
+
+	static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+public:
+	using result_type = uint64_t;
+
+	/**
+	 * Seed the state with splitmix64 so every seed, including 0, gives a well mixed state
+	 * @param seed
+	 */
+	explicit rng(uint64_t seed = 0);
+
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return UINT64_MAX; }
+
+	/**
+	 * @return the next 64 random bits
+	 */
+	result_type operator()() {
+		const uint64_t result = rotl(state[1] * 5, 7) * 9;
+		const uint64_t t      = state[1] << 17;
+
+		state[2] ^= state[0];
+		state[3] ^= state[1];
+		state[1] ^= state[2];
+		state[0] ^= state[3];
+		state[2] ^= t;
+		state[3] = rotl(state[3], 45);
+
+		return result;
+	}
+
+	/**
+	 * Unbiased random integer in [0, bound) with Lemire's multiply and reject method, which
+	 * almost never needs a division
+	 * @param bound larger than 0
+	 * @return
+	 */
+	uint64_t below(uint64_t bound) {
+		auto product = static_cast<__uint128_t>((*this)()) * bound;
+		auto low     = static_cast<uint64_t>(product);
+		if (low < bound) {
+			const uint64_t threshold = -bound % bound;
+			while (low < threshold) {
+				product = static_cast<__uint128_t>((*this)()) * bound;
+				low     = static_cast<uint64_t>(product);
+			}
+		}
+		return static_cast<uint64_t>(product >> 64);
+	}
+
+	/**
+	 * @return a random double in [0, 1) with 53 random bits
+	 */
+	double uniform() { return static_cast<double>((*this)() >> 11) * 0x1.0p-53; }
+
+	/**
+	 * @return a fair coin flip
+	 */
+	bool coin() { return (*this)() >> 63; }
+
+	/**
+	 * Fill an array with random 64-bit masks, every bit is set with probability 1/2
+	 * @param masks
+	 * @param count
+	 */
+	void fill(uint64_t* masks, size_t count) {
+		for (size_t i = 0; i < count; ++i) masks[i] = (*this)();
+	}
+
+	/**
+	 * Advance the state by 2^128 draws, so 2^128 non-overlapping streams can be split off
+	 */
+	void jump();
+
+	/**
+	 * Split off an independent stream: the current stream is returned and this generator
+	 * jumps ahead
+	 * @return
+	 */
+	rng split() {
+		rng stream = *this;
+		jump();
+		return stream;
+	}
+};
+
+// the generator of the calling thread: a solve gives every thread of its pool a stream of its seed,
+// a thread outside a solve starts from seed 0 until it assigns a generator of its own
+rng& generator();
+
+#endif    // MKP_RNG_H
@@ -2,171 +2,456 @@
 // Created by ward on 5/1/22.
 //
 
+#include "budget.h"
+#include "engine.h"
+#include "population.h"
+#include "rng.h"
 #include "solution.h"
+#include "spsc_queue.h"
 #include "util.h"
 
+#include <atomic>
 #include <chrono>
-#include <csignal>
 #include <queue>
 #include <ranges>
 
 using namespace std::chrono;
 
-// Atomic variable to indicate when an SLA algorithm should stop
-volatile std::sig_atomic_t stop = 0;
+/**
+ * @param p
+ * @param b
+ * @return the milliseconds the geometric annealing schedule cools over: the wall time of the
+ * budget, or the runtime of the problem when the budget has no wall time
+ */
+static double schedule(const problem& p, const budget& b) {
+	if (b.time_limit() == milliseconds::max()) return p.runtime() * 1000.0;
+	return static_cast<double>(b.time_limit().count());
+}
 
 /**
- * Signal handler that sets the stop variable
- * @param signum
+ * Move to a random neighbour in the 3-neighbourhood of the solution in place and keep it
+ * according to the Metropolis condition
+ * @param p
+ * @param T the temperature
+ * @return whether the neighbour was accepted
  */
-void handle_stop(int signum __attribute__((unused))) { stop = 1; }
+template<size_t W> bool Solution<W>::anneal(const problem& p, double T) {
+	const auto current = value;
+	tally(counter::steps);
+
+	// Remove 3 random items
+	std::array<unsigned int, 3> removed{};
+	for (unsigned int& r : removed) {
+		r = random_item();
+		remove_unchecked(r, p);
+	}
+
+	// Apply Toyoda after removal
+	// The removed items are blocked so the constructive heuristic won't consider them again
+	for (unsigned int r : removed) { block(r); }
+	toyoda(p);
+	for (unsigned int r : removed) { unblock(r); }
+
+	// Metropolis condition
+	// Accept any improving neighbour, and a worsening neighbour with a probability depending on
+	// the temperature
+	if (value >= current ||
+	    std::exp(-static_cast<double>(current - value) / T) > generator().uniform()) {
+		commit();
+		tally(counter::accepted);
+		return true;
+	}
+
+	rollback(p);
+	return false;
+}
 
 /**
  * Simulated annealing algorithm
  * @param p
+ * @param b the budget, every step is an iteration
  * @return
  */
-Solution simulated_annealing(const problem& p) {
-	// Set the signal handler and schedule an alarm
-	std::signal(SIGALRM, handle_stop);
-	alarm(p.runtime());
-
+template<size_t W> Solution<W> simulated_annealing(const problem& p, budget& b) {
 	// Construct an initial solution using the Random constructive heuristic
-	auto solution = Solution(p, &Solution::random);
+	b.spend(0, 1);
+	auto solution = Solution<W>(p, random_ch{});
+	b.report(solution.value);
 
 	// Set the geometric annealing schedule
 	const auto init_T = p.initial_temperature();
 	auto       T      = init_T;
-	const auto alpha  = p.cooling_factor();
+	const auto alpha  = p.cooling_factor(schedule(p, b));
 
-	auto begin = steady_clock::now();
+	uint64_t accepted = 0;
+	for (size_t i = 1; b.spend(1, 1); ++i) {
+		accepted += solution.anneal(p, T);
+		b.report(solution.value);
 
-	while (true) {
-		// Stop when the alarm has run
-		if (stop) {
-			stop = 0;
-			return solution;
+		// Do 20000 iterations at each temperature
+		// Decrease the temperature using the schedule based on how many milliseconds have passed
+		if (i % 20000 == 0) {
+			telemetry::temperature(T, 20000, accepted);
+			accepted = 0;
+			T        = init_T * std::pow(alpha, duration_cast<milliseconds>(b.elapsed()).count());
 		}
+	}
 
-		// Do 20000 iterations at each temperature
-		for (int i = 0; i < 20000; ++i) {
-			// Create a neighbour in the 3-neighbourhood of the solution
-			auto neighbour = solution;
-
-			// Remove 3 random items
-			std::array<unsigned int, 3> removed{};
-			for (unsigned int& r : removed) {
-				r = neighbour.random_item();
-				neighbour.remove_unchecked(r, p);
-			}
+	return solution;
+}
+
+/**
+ * Simulated annealing with several replicas spread over the threads, a thread with several
+ * replicas runs them in turn.
+ * With parallel tempering every replica anneals at a fixed temperature of a geometric ladder from
+ * the initial temperature down to the final temperature of the schedule, and every interval
+ * steps a replica offers its state to the hotter replica below it. The hotter replica answers at
+ * its next interval with the Metropolis criterion for swapping the two states. The offers and
+ * answers go through lock-free queues and neither replica waits: the offering replica keeps
+ * annealing and only takes the hotter state when the answer arrives, so an exchange is barrier
+ * free.
+ * With independent multi-start every replica follows the geometric schedule on its own.
+ * In both modes a replica keeps a copy of its state whenever it beats the value of the incumbent
+ * shared by all replicas through an atomic, so the copies are rare.
+ * @param p
+ * @param sa
+ * @param b the budget shared by the replicas, every step of a replica is an iteration
+ * @return the best solution any replica has visited
+ */
+template<size_t W>
+Solution<W> parallel_annealing(const problem& p, const simulated_annealing_sla& sa, budget& b) {
+	auto&        pool      = threads();
+	const size_t count     = sa.replicas ? sa.replicas : pool.size();
+	const bool   tempering = sa.mode == annealing_mode::tempering;
+
+	const auto init_T  = p.initial_temperature();
+	const auto alpha   = p.cooling_factor(schedule(p, b));
+	const auto final_T = init_T * std::pow(alpha, schedule(p, b));
+
+	// Every replica is only touched by its own thread, the counters are kept per cache line
+	struct alignas(64) replica {
+		std::optional<Solution<W>> solution;
+		std::optional<Solution<W>> best;
+		double                     T;
+		size_t                     steps     = 0;
+		size_t                     accepted  = 0;
+		// Answered offers of the replica above and the accepted ones
+		size_t                     answered  = 0;
+		size_t                     exchanged = 0;
+		// Whether an offer to the replica below waits for its answer
+		bool                       offered   = false;
+	};
+	std::vector<replica> replicas(count);
+	// The rungs of the ladder, replica 0 is the hottest
+	const double rungs = static_cast<double>(std::max<size_t>(count - 1, 1));
+	for (size_t k = 0; k < count; ++k) {
+		const double rung = tempering ? static_cast<double>(k) / rungs : 0;
+		replicas[k].T     = init_T * std::pow(final_T / init_T, rung);
+	}
+
+	// offers[k] carries the state of replica k + 1 to replica k, answers[k] the state of replica k
+	// back when the swap is accepted and nothing when it is rejected
+	std::vector<std::unique_ptr<spsc_queue<Solution<W>>>>                offers;
+	std::vector<std::unique_ptr<spsc_queue<std::optional<Solution<W>>>>> answers;
+	for (size_t k = 0; tempering && k + 1 < count; ++k) {
+		offers.push_back(std::make_unique<spsc_queue<Solution<W>>>(1));
+		answers.push_back(std::make_unique<spsc_queue<std::optional<Solution<W>>>>(1));
+	}
+
+	// The value of the best solution of all replicas
+	std::atomic<unsigned int> incumbent = 0;
+
+	pool.run([&](size_t worker) {
+		for (size_t k = worker; k < count; k += pool.size()) {
+			b.spend(0, 1);
+			replicas[k].solution.emplace(p, random_ch{});
+			replicas[k].best = replicas[k].solution;
+			b.report(replicas[k].solution->value);
+		}
+
+		while (!b.exhausted()) {
+			for (size_t k = worker; k < count; k += pool.size()) {
+				auto& r = replicas[k];
+				auto& s = *r.solution;
+
+				for (size_t i = 0; i < sa.interval && b.spend(1, 1); ++i) {
+					r.accepted += s.anneal(p, r.T);
+					++r.steps;
+					b.report(s.value);
+					// Keep a copy before publishing the value, so the incumbent is always kept
+					if (s.value > incumbent.load(std::memory_order_relaxed)) {
+						r.best         = s;
+						unsigned int v = incumbent.load(std::memory_order_relaxed);
+						while (s.value > v && !incumbent.compare_exchange_weak(v, s.value)) {}
+					}
+				}
 
-			// Apply Toyoda after removal
-			// The bool indicating the selection of the item is temporally set to true so the
-			// constructive heuristic won't consider it again
-			for (unsigned int r : removed) { neighbour.sol[r] = true; }
-			neighbour.toyoda(p);
-			for (unsigned int r : removed) { neighbour.sol[r] = false; }
-
-			// Metropolis condition
-			if (neighbour >= solution) {
-				// Accept any improving neighbour
-				solution = neighbour;
-			} else {
-				// Accept a worsening neighbour with a probability depending on the temperature
-				auto accept_chance =
-					std::exp(-static_cast<double>(solution.value - neighbour.value) / T);
-				if (accept_chance > static_cast<double>(std::rand()) / RAND_MAX) {
-					solution = neighbour;
+				if (!tempering) {
+					// Decrease the temperature using the schedule
+					const auto ms = duration_cast<milliseconds>(b.elapsed()).count();
+					r.T           = init_T * std::pow(alpha, ms);
+					continue;
+				}
+
+				// Answer the offer of the colder replica above with the Metropolis criterion for
+				// swapping the states at the two temperatures
+				if (k + 1 < count) {
+					if (auto offer = offers[k]->try_pop()) {
+						const double exponent =
+							(1 / r.T - 1 / replicas[k + 1].T) *
+							(static_cast<double>(offer->value) - static_cast<double>(s.value));
+						++r.answered;
+						if (exponent >= 0 || std::exp(exponent) > generator().uniform()) {
+							++r.exchanged;
+							answers[k]->try_push(std::move(s));
+							s = std::move(*offer);
+						} else {
+							answers[k]->try_push(std::nullopt);
+						}
+					}
+				}
+
+				// Take the answer of the hotter replica below and offer it the current state
+				if (k > 0) {
+					if (r.offered) {
+						if (auto answer = answers[k - 1]->try_pop()) {
+							r.offered = false;
+							if (*answer) s = std::move(**answer);
+						}
+					}
+					if (!r.offered) r.offered = offers[k - 1]->try_push(s);
 				}
 			}
 		}
-
-		// Decrease the temperature using the schedule based on how many milliseconds have passed
-		T = init_T *
-		    std::pow(alpha, duration_cast<milliseconds>(steady_clock::now() - begin).count());
+	});
+
+	// The rates of the replicas go to the telemetry, and with verbose to the diagnostics
+	for (const auto& r : replicas)
+		telemetry::replica({ r.T, r.steps, r.accepted, r.answered, r.exchanged });
+	if (diagnostics) {
+		const auto seconds = duration<double>(b.elapsed()).count();
+		for (size_t k = 0; k < count; ++k) {
+			const auto& r = replicas[k];
+			*diagnostics << "replica " << k << ": T = " << r.T << ", "
+			             << static_cast<double>(r.steps) / seconds << " steps/s, acceptance "
+			             << 100.0 * static_cast<double>(r.accepted) /
+			                    static_cast<double>(std::max<size_t>(r.steps, 1))
+			             << "%";
+			if (tempering && r.answered)
+				*diagnostics << ", exchange with " << k + 1 << " "
+				             << 100.0 * static_cast<double>(r.exchanged) /
+				                    static_cast<double>(r.answered)
+				             << "%";
+			*diagnostics << std::endl;
+		}
 	}
+
+	const Solution<W>* best = &*replicas.front().best;
+	for (const auto& r : replicas)
+		if (*r.best > *best) best = &*r.best;
+	return *best;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/**
+ * Binary tournament selection, the draws are sequenced so a seed always picks the same parents
+ * @param population
+ * @return the better of two random individuals
+ */
+template<size_t W> static const Solution<W>& tournament(const Population<W>& population) {
+	const auto& a = population[generator().below(population.size())];
+	const auto& b = population[generator().below(population.size())];
+	return std::max(a, b);
+}
+
+/**
+ * Recombine two parents into an invalid child with crossover, mutate it and repair it
+ * @param a
+ * @param b
+ * @param p
+ * @return a valid child
+ */
+template<size_t W>
+Solution<W> Solution<W>::offspring(const Solution& a, const Solution& b, const problem& p) {
+	// Recombine them into an invalid child solution using crossover
+	Solution child = crossover(a, b, p);
+	// Apply the first improvement algorithm with Toyoda
+	// This is disabled as it didn't improve the solution quality
+	// child.repair(p
+	// child.first_improvement(p, &Solution::toyoda);
+	// Mutate the invalid child
+	child.mutate(p);
+	// Make the child valid again
+	child.repair(p);
+	child.commit();
+	// Apply the first improvement algorithm with Toyoda
+	// This is disabled as it didn't improve the solution quality
+	// child.first_improvement(p, &Solution::toyoda);
+	return child;
+}
+
+/**
+ * One generation of the steady-state memetic algorithm: breed a child from two parents chosen by
+ * binary tournament selection and let it replace the worst individual, unless it already exists
+ * @param population
+ * @param p
+ * @param b the budget the child is reported to
+ */
+template<size_t W> static void evolve(Population<W>& population, const problem& p, budget& b) {
+	// Apply binary tournament selection for both parents
+	const auto& parent_1 = tournament(population);
+	const auto& parent_2 = tournament(population);
+
+	Solution<W> child = Solution<W>::offspring(parent_1, parent_2, p);
+	b.report(child.profit());
+	tally(counter::generations);
+
+	// If the child already exists, don't add it
+	if (population.contains(child)) {
+		tally(counter::duplicates);
+		return;
+	}
+
+	// Replace the worst scoring individual with the child
+	//	if (child > population.worst()) { population.replace_worst(std::move(child)); }
+	population.replace_worst(std::move(child));
+}
+
+/**
+ * Initialize a population with the random constructive heuristic
+ * @param population
+ * @param p
+ * @param N the number of individuals
+ * @param b the budget the individuals are spent from and reported to
+ */
+template<size_t W>
+static void initialize(Population<W>& population, const problem& p, size_t N, budget& b) {
+	b.spend(0, N);
+	for (size_t i = 0; i < N; ++i) {
+		population.push(Solution<W>(p, random_ch{}));
+		b.report(population[i].profit());
+	}
+}
+
 /**
  * Memetic/Evolutionary algorithm
  * @param p
+ * @param N the number of individuals
+ * @param b the budget, every generation is an iteration
  * @return
  */
-Solution memetic_algorithm(const problem& p) {
-	// Set the signal handler and schedule an alarm
-	std::signal(SIGALRM, handle_stop);
-	alarm(p.runtime());
-
-	// Initialize the population with the random constructive heuristic
-	auto                  N = 100;
-	std::vector<Solution> population;
-	for (int i = 0; i < N; ++i) { population.emplace_back(p, &Solution::random); }
-
-	while (true) {
-		// Stop when the alarm has run and return the best individual
-		if (stop) {
-			stop = 0;
-			return *std::max_element(population.begin(), population.end());
-		}
+template<size_t W> Solution<W> memetic_algorithm(const problem& p, size_t N, budget& b) {
+	Population<W> population;
+	initialize(population, p, N, b);
+
+	while (b.spend(1, 1)) evolve(population, p, b);
 
-		// Apply binary tournament selection for both parents
-		auto parent_1 = std::max(population[std::rand() % N], population[std::rand() % N]);
-		auto parent_2 = std::max(population[std::rand() % N], population[std::rand() % N]);
-
-		// Recombine them into an invalid child solution using crossover
-		Solution child = crossover(parent_1, parent_2, p);
-		// Apply the first improvement algorithm with Toyoda
-		// This is disabled as it didn't improve the solution quality
-		// child.repair(p
-		// child.first_improvement(p, &Solution::toyoda);
-		// Mutate the invalid child
-		child.mutate(p);
-		// Make the child valid again
-		child.repair(p);
-		// Apply the first improvement algorithm with Toyoda
-		// This is disabled as it didn't improve the solution quality
-		// child.first_improvement(p, &Solution::toyoda);
-
-		// If the child already exists, don't add it
-		if (std::find(population.begin(), population.end(), child) != population.end()) {
-			continue;
+	// Return the best individual
+	return population.best();
+}
+
+/**
+ * Island model of the memetic algorithm: every island evolves its own population and every
+ * interval generations sends copies of its best individuals to the next island in a ring or to a
+ * random island. The islands are spread over the threads, a thread with several islands evolves
+ * them in turn. The migrants travel through a bounded lock-free queue for every pair of islands,
+ * so an island never waits for another one: a migrant to a full queue is dropped.
+ * @param p
+ * @param ma
+ * @param b the budget shared by the islands, every generation of an island is an iteration
+ * @return the best individual of all islands
+ */
+template<size_t W>
+Solution<W> island_model(const problem& p, const memetic_sla& ma, budget& b) {
+	auto&        pool    = threads();
+	const size_t islands = ma.islands ? ma.islands : pool.size();
+	const bool   ring    = ma.topology == migration_topology::ring;
+
+	// The queue from island i to island j is queues[i * islands + j], a ring only needs the queues
+	// to the next island
+	std::vector<std::unique_ptr<spsc_queue<Solution<W>>>> queues(islands * islands);
+	for (size_t i = 0; i < islands; ++i)
+		for (size_t j = 0; j < islands; ++j)
+			if (i != j && (!ring || j == (i + 1) % islands))
+				queues[i * islands + j] = std::make_unique<spsc_queue<Solution<W>>>(2 * ma.elites);
+
+	std::vector<Population<W>> populations(islands);
+
+	pool.run([&](size_t worker) {
+		// Every thread initializes its own islands, so their individuals are drawn from its stream
+		for (size_t i = worker; i < islands; i += pool.size())
+			initialize(populations[i], p, ma.population, b);
+
+		for (size_t generation = 1; !b.exhausted(); ++generation) {
+			for (size_t i = worker; i < islands && b.spend(1, 1); i += pool.size()) {
+				auto& population = populations[i];
+				evolve(population, p, b);
+				if (generation % ma.interval != 0 || islands == 1) continue;
+
+				// Send copies of the best individuals
+				size_t to = (i + 1) % islands;
+				if (!ring) {
+					to = generator().below(islands - 1);
+					to += to >= i;
+				}
+				for (auto elite : population.elite(ma.elites))
+					queues[i * islands + to]->try_push(population[elite]);
+
+				// A migrant replaces the worst individual when it is better and not in the
+				// population yet
+				for (size_t from = 0; from < islands; ++from) {
+					auto& queue = queues[from * islands + i];
+					if (!queue) continue;
+					while (auto migrant = queue->try_pop())
+						if (*migrant > population.worst() && !population.contains(*migrant))
+							population.replace_worst(std::move(*migrant));
+				}
+			}
 		}
+	});
 
-		// Replace the worst scoring individual with the child
-		auto min = std::min_element(population.begin(), population.end());
-//		if (child > *min) { *min = std::move(child); }
-		*min = std::move(child);
+	if (diagnostics) {
+		const auto seconds = duration<double>(b.elapsed()).count();
+		*diagnostics << islands << " islands on " << pool.size() << " threads: "
+		             << static_cast<double>(b.iterations_spent()) / seconds << " generations/s"
+		             << std::endl;
 	}
+
+	const Solution<W>* best = &populations.front().best();
+	for (const auto& population : populations)
+		if (population.best() > *best) best = &population.best();
+	return *best;
 }
 
 /**
- * Recombine two solutions using uniform crossover
+ * Recombine two solutions using uniform crossover, 64 items at a time: the child is
+ * a ^ (diff & mask) with diff = a ^ b and one random mask per word, so every item where the
+ * parents differ is copied from b with 50% chance. Only the flipped items update the value and
+ * the resources.
  * @param a
  * @param b
  * @param p
  * @return an invalid solution
  */
-Solution crossover(const Solution& a, const Solution& b, const problem& p) {
-	auto child = a;
-
-	// For every item choose if we copy its inclusion from a or b
-	for (size_t item = 0; item < child.sol.size(); ++item) {
-		// Only update the child with b if b is different
-		if (a.sol[item] != b.sol[item]) {
-			// With 50% chance copy it from b
-			if (rand() & 1) {
-				child.sol[item] = b.sol[item];
-
-				// Update the value and resources when changed
-				auto sign = child.sol[item] ? 1 : -1;
-
-				child.value += sign * p.profits[item];
-				for (size_t resource = 0; resource < child.resources_used.size(); ++resource) {
-					child.resources_used[resource] += sign * p.constraints[item][resource];
-				}
-			}
+template<size_t W>
+Solution<W> crossover(const Solution<W>& a, const Solution<W>& b, const problem& p) {
+	scoped_timer timer(counter::crossover_ns);
+	auto         child = a;
+
+	// One random bit per item, drawn 64 at a time
+	thread_local Vector<uint64_t> masks;
+	masks.resize(a.sol.words());
+	generator().fill(masks.data(), masks.size());
+
+	for (size_t w = 0; w < masks.size(); ++w) {
+		// The items that differ and are copied from b
+		for (uint64_t flips = (a.sol.word(w) ^ b.sol.word(w)) & masks[w]; flips;
+		     flips &= flips - 1) {
+			const size_t item = w * 64 + static_cast<size_t>(std::countr_zero(flips));
+			if (b.sol[item]) child.include(item, p);
+			else
+				child.exclude(item, p);
 		}
 	}
 
@@ -177,18 +462,21 @@ Solution crossover(const Solution& a, const Solution& b, const problem& p) {
  * Mutate the child by flipping two item's inclusion at random
  * @param p
  */
-void Solution::mutate(const problem& p) {
+template<size_t W> void Solution<W>::mutate(const problem& p) {
 	for (int i = 0; i < 2; ++i) {
 		// Flip a random item's inclusion
-		auto item = rand() % sol.size();
-		sol[item].flip();
+		auto item = generator().below(sol.size());
+		if (sol[item]) deselect(item, p);
+		else
+			select(item, p);
 
 		// Update the value and resources
 		auto sign = sol[item] ? 1 : -1;
 
 		value += sign * p.profits[item];
+		const int* weights = p.constraints[item];
 		for (size_t resource = 0; resource < resources_used.size(); ++resource) {
-			resources_used[resource] += sign * p.constraints[item][resource];
+			resources_used[resource] += sign * weights[resource];
 		}
 	}
 }
@@ -200,13 +488,15 @@ void Solution::mutate(const problem& p) {
  * but without updating the U and V vectors for speed
  * @param p
  */
-void Solution::repair(const problem& p) {
+template<size_t W> void Solution<W>::repair(const problem& p) {
+	scoped_timer timer(counter::repair_ns);
+
 	// Create the insert order
 	Vector<size_t> indices(sol.size());
 	std::iota(indices.begin(), indices.end(), 0);
 
-	// Calculate U then V
-	auto v = p.A * (sol * p.A).normalize();
+	// Calculate U from the rows of the selected items only, then V along the rows of A^T
+	auto v = (sol * p.A).normalize() * p.A_t;
 	// Calculate the pseudo-utility
 	for (size_t i = 0; i < v.size(); ++i) v[i] = static_cast<double>(p.profits[i]) / v[i];
 
@@ -215,9 +505,54 @@ void Solution::repair(const problem& p) {
 
 	// Remove items in order until no constraint is violated
 	if (invalid(p))
-		for (const auto& index : std::ranges::reverse_view(indices))
-			if (remove(index, p) && !invalid(p)) break;
+		for (const auto& index : std::ranges::reverse_view(indices)) {
+			if (!remove(index, p)) continue;
+			tally(counter::repair_drops);
+			if (!invalid(p)) break;
+		}
 
 	// Add as many items as possible in order
-	for (const auto& index : indices) add(index, p);
+	for (const auto& index : indices)
+		if (add(index, p)) tally(counter::repair_adds);
 }
+
+template Solution<dynamic_width> crossover(const Solution<dynamic_width>& a,
+                                           const Solution<dynamic_width>& b, const problem& p);
+template Solution<16> crossover(const Solution<16>& a, const Solution<16>& b, const problem& p);
+template Solution<32> crossover(const Solution<32>& a, const Solution<32>& b, const problem& p);
+
+template bool Solution<dynamic_width>::anneal(const problem& p, double T);
+template bool Solution<16>::anneal(const problem& p, double T);
+template bool Solution<32>::anneal(const problem& p, double T);
+
+template void Solution<dynamic_width>::mutate(const problem& p);
+template void Solution<16>::mutate(const problem& p);
+template void Solution<32>::mutate(const problem& p);
+
+template void Solution<dynamic_width>::repair(const problem& p);
+template void Solution<16>::repair(const problem& p);
+template void Solution<32>::repair(const problem& p);
+
+template Solution<dynamic_width> Solution<dynamic_width>::offspring(const Solution&,
+                                                                  const Solution&, const problem&);
+template Solution<16> Solution<16>::offspring(const Solution&, const Solution&, const problem&);
+template Solution<32> Solution<32>::offspring(const Solution&, const Solution&, const problem&);
+
+template Solution<dynamic_width> simulated_annealing(const problem& p, budget& b);
+template Solution<16>            simulated_annealing(const problem& p, budget& b);
+template Solution<32>            simulated_annealing(const problem& p, budget& b);
+
+template Solution<dynamic_width> parallel_annealing(const problem& p,
+                                                    const simulated_annealing_sla& sa, budget& b);
+template Solution<16> parallel_annealing(const problem& p, const simulated_annealing_sla& sa,
+                                         budget& b);
+template Solution<32> parallel_annealing(const problem& p, const simulated_annealing_sla& sa,
+                                         budget& b);
+
+template Solution<dynamic_width> memetic_algorithm(const problem& p, size_t N, budget& b);
+template Solution<16>            memetic_algorithm(const problem& p, size_t N, budget& b);
+template Solution<32>            memetic_algorithm(const problem& p, size_t N, budget& b);
+
+template Solution<dynamic_width> island_model(const problem& p, const memetic_sla& ma, budget& b);
+template Solution<16>            island_model(const problem& p, const memetic_sla& ma, budget& b);
+template Solution<32>            island_model(const problem& p, const memetic_sla& ma, budget& b);
@@ -3,9 +3,66 @@
 //
 
 #include "solution.h"
+#include "kernels.h"
+#include "rng.h"
+#include "toyoda.h"
 #include "util.h"
 
-bool verbose = false;
+thread_local bool          verbose     = false;
+thread_local std::ostream* diagnostics = nullptr;
+
+/**
+ * Mark an item as selected, append it to the selected items and update the hash
+ * @param item
+ * @param problem
+ */
+template<size_t W> void Solution<W>::select(size_t item, const problem& problem) {
+	sol.set(item);
+	zobrist ^= problem.zobrist[item];
+	position[item] = static_cast<unsigned int>(selected.size());
+	selected.push_back(static_cast<unsigned int>(item));
+}
+
+/**
+ * Mark an item as not selected, move the last selected item into its place and update the hash
+ * @param item
+ * @param problem
+ */
+template<size_t W> void Solution<W>::deselect(size_t item, const problem& problem) {
+	sol.reset(item);
+	zobrist ^= problem.zobrist[item];
+	const auto last          = selected.back();
+	selected[position[item]] = last;
+	position[last]           = position[item];
+	selected.pop_back();
+}
+
+/**
+ * Include an item and update the value and resources without checks or journaling
+ * @param item
+ * @param problem
+ */
+template<size_t W> void Solution<W>::include(size_t item, const problem& problem) {
+	select(item, problem);
+	value += problem.profits[item];
+	const int* weights = problem.constraints[item];
+	for (size_t i = 0; i < resources_used.size(); ++i) resources_used[i] += weights[i];
+}
+
+/**
+ * Exclude an item and update the value and resources without checks or journaling
+ * @param item
+ * @param problem
+ */
+template<size_t W> void Solution<W>::exclude(size_t item, const problem& problem) {
+	deselect(item, problem);
+	value -= problem.profits[item];
+	if constexpr (W == dynamic_width)
+		active_kernels.remove(resources_used.data(), problem.constraints[item],
+		                      resources_used.size());
+	else
+		fixed_kernels<W>::active.remove(resources_used.data(), problem.constraints[item]);
+}
 
 /**
  * Add an item to the solution
@@ -13,25 +70,26 @@ bool verbose = false;
  * @param problem
  * @return success
  */
-bool Solution::add(const size_t item, const problem& problem) {
+template<size_t W> bool Solution<W>::add(const size_t item, const problem& problem) {
 	// Avoid adding twice
 	if (sol[item]) return false;
 
-	// Check the constraints
-	for (size_t i = 0; i < resources_used.size(); ++i) {
-		if (resources_used[i] + problem.constraints[item][i] > problem.capacities[i]) {
+	// Check the constraints and update the resources in one pass
+	if constexpr (W == dynamic_width) {
+		if (!active_kernels.add(resources_used.data(), problem.constraints[item],
+		                        problem.capacities, resources_used.size()))
+			return false;
+	} else {
+		if (!fixed_kernels<W>::active.add(resources_used.data(), problem.constraints[item],
+		                                 problem.capacities))
 			return false;
-		}
 	}
 
-	// Add the item and update the resources
-	sol[item] = true;
+	// Add the item
+	select(item, problem);
 	value += problem.profits[item];
-	for (size_t i = 0; i < resources_used.size(); ++i) {
-		resources_used[i] += problem.constraints[item][i];
-	}
 
-	++size;
+	journal.push_back({ static_cast<unsigned int>(item), true });
 	return true;
 }
 
@@ -41,7 +99,7 @@ bool Solution::add(const size_t item, const problem& problem) {
  * @param problem
  * @return success
  */
-bool Solution::remove(size_t item, const problem& problem) {
+template<size_t W> bool Solution<W>::remove(size_t item, const problem& problem) {
 	// Avoid adding twice
 	if (!sol[item]) return false;
 
@@ -56,44 +114,67 @@ bool Solution::remove(size_t item, const problem& problem) {
  * @param problem
  * @return
  */
-void Solution::remove_unchecked(size_t item, const problem& problem) {
-	// Remove the item and update the resources
-	sol[item] = false;
-	value -= problem.profits[item];
-	for (size_t i = 0; i < resources_used.size(); ++i) {
-		resources_used[i] -= problem.constraints[item][i];
+template<size_t W> void Solution<W>::remove_unchecked(size_t item, const problem& problem) {
+	exclude(item, problem);
+	journal.push_back({ static_cast<unsigned int>(item), false });
+}
+
+/**
+ * Undo the adds and removes made after a checkpoint, in reverse order
+ * @param problem
+ * @param checkpoint
+ */
+template<size_t W> void Solution<W>::rollback(const problem& problem, size_t checkpoint) {
+	while (journal.size() > checkpoint) {
+		auto [item, added] = journal.back();
+		journal.pop_back();
+
+		if (added) exclude(item, problem);
+		else
+			include(item, problem);
 	}
+}
 
-	--size;
+/**
+ * Redo a sequence of adds and removes that was recorded in a journal
+ * @param problem
+ * @param moves
+ */
+template<size_t W> void Solution<W>::replay(const problem& problem, const Vector<move>& moves) {
+	for (auto [item, added] : moves) {
+		if (added) include(item, problem);
+		else
+			exclude(item, problem);
+	}
+	journal.insert(journal.end(), moves.begin(), moves.end());
 }
 
 /**
- * Create a solution
+ * Create an empty solution
  * @param p
- * @param CH the constructive heuristic to use
  */
-Solution::Solution(const problem& p, void (Solution::*CH)(const problem&)):
-	value(0), size(0), sol(p.n, false), resources_used(p.m, 0) {
-	(this->*CH)(p);
+template<size_t W>
+Solution<W>::Solution(const problem& p): value(0), sol(p.n), position(p.n, 0) {
+	selected.reserve(p.n);
+	if constexpr (W == dynamic_width) resources_used = Resources(padded(p.m), 0);
 }
 
 /**
  * Create an alternative representation of the solution
  * @return a vector of selected items and a vector of discarded items
  */
-std::pair<Vector<size_t>, Vector<size_t>> Solution::representation() const {
-	Vector<size_t> selected;
-	Vector<size_t> discarded;
+template<size_t W>
+std::pair<Vector<size_t>, Vector<size_t>> Solution<W>::representation() const {
+	Vector<size_t> items;
+	items.assign(selected.begin(), selected.end());
+	std::sort(items.begin(), items.end());
 
-	for (size_t i = 0; i < sol.size(); ++i) {
-		if (sol[i]) {
-			selected.push_back(i);
-		} else {
-			discarded.push_back(i);
-		}
-	}
+	Vector<size_t> discarded;
+	discarded.reserve(sol.size() - items.size());
+	for (size_t i = 0; i < sol.size(); ++i)
+		if (!sol[i]) discarded.push_back(i);
 
-	return std::pair{ selected, discarded };
+	return std::pair{ items, discarded };
 }
 
 /**
@@ -102,7 +183,7 @@ std::pair<Vector<size_t>, Vector<size_t>> Solution::representation() const {
  * @param solution
  * @return
  */
-std::ostream& operator<<(std::ostream& os, const Solution& solution) {
+template<size_t W> std::ostream& operator<<(std::ostream& os, const Solution<W>& solution) {
 	if (!verbose) {
 		os << solution.value;
 		return os;
@@ -112,9 +193,7 @@ std::ostream& operator<<(std::ostream& os, const Solution& solution) {
 	if (selected.empty()) os << "No items selected in the solution!\n";
 	else {
 		os << "Items in solution:\n[ ";
-		for (size_t i = 0; i < solution.sol.size(); i++) {
-			if (solution.sol[i]) os << i << " ";
-		}
+		for (const auto item : selected) { os << item << " "; }
 		os << "]\nSolution value: " << solution.value << "\n";
 	}
 
@@ -131,230 +210,103 @@ std::ostream& operator<<(std::ostream& os, const Solution& solution) {
  * Update the solution with the random constructive heuristic
  * @param p
  */
-void Solution::random(const problem& p) {
+template<size_t W> void Solution<W>::random(const problem& p) {
 	// Create the random insert order
-	int* v = create_shuffled(sol.size());
+	thread_local Vector<int> v;
+	v.resize(sol.size());
+	std::iota(v.begin(), v.end(), 0);
+	shuffle_int(v.data(), static_cast<int>(v.size()));
 
 	for (size_t i = 0; i < sol.size(); i++) add(v[i], p);
-
-	free(v);
 }
 
 /**
  * Update the solution with the greedy constructive heuristic
  * @param p
  */
-void Solution::greedy(const problem& p) {
-	// Create the insert order sorted by profit
-	Vector<size_t> indices(sol.size());
-	std::iota(indices.begin(), indices.end(), 0);
-	std::sort(indices.begin(), indices.end(),
-	          [&p](size_t a, size_t b) { return p.profits[a] > p.profits[b]; });
-
-	for (const auto index : indices) add(index, p);
-}
-
-/**
- * Update the solution with the toyoda constructive heuristic
- * @param p
- */
-void Solution::toyoda(const problem& p) {
-	// Create the insert order
-	Vector<size_t> indices(sol.size());
-	std::iota(indices.begin(), indices.end(), 0);
-
-	// Keep adding items while possible
-	bool added = true;
-	while (added) {
-		added = false;
-
-		// Calculate U then V
-		auto v = p.A * (sol * p.A).normalize();
-		// Calculate the pseudo-utility
-		for (size_t i = 0; i < v.size(); ++i) v[i] = static_cast<double>(p.profits[i]) / v[i];
-
-		// Sort insert order by pseudo-utility
-		auto sorted_indices = indices;
-		std::sort(sorted_indices.begin(), sorted_indices.end(),
-		          [&v](size_t a, size_t b) { return v[a] > v[b]; });
-
-		// Insert the first item possible
-		for (const auto index : sorted_indices)
-			if (add(index, p)) {
-				added = true;
-				break;
-			}
-	}
+template<size_t W> void Solution<W>::greedy(const problem& p) {
+	// Insert in the order sorted by profit
+	for (const auto index : p.greedy_order) add(index, p);
 }
 
 /**
- * Update the solution with the first improvement iterative improvement algorithm
+ * Update the solution with the toyoda constructive heuristic.
+ * The pseudo-utilities are maintained incrementally: U grows by the row of every inserted item,
+ * so V = A * U grows by A times the inserted row. V is kept for every item and updated one
+ * resource-major column at a time, which vectorizes over the items, and U itself is only computed
+ * once. The next item is selected with a tournament tree instead of sorting all items. Items that
+ * do not fit are dropped for good since the used resources only grow. Ties are broken by the
+ * lowest item index.
  * @param p
- * @param CH the constructive heuristic to use
  */
-void Solution::first_improvement(const problem& p, void (Solution::*CH)(const problem&)) {
-	// Keep improving until a local minimum is reached
-	bool changed;
-	do {
-		changed = false;
-		// Create the removal order
-		auto shuffled = create_shuffled(sol.size());
-
-		for (size_t i = 0; i < sol.size(); ++i) {
-			// Try to remove an item
-			if (!sol[shuffled[i]]) continue;
-			auto solution = *this;
-			solution.remove_unchecked(shuffled[i], p);
-
-			// Apply the constructive heuristic after removal
-			// The bool indicating the selection of the item is temporally set to true so the
-			// constructive heuristic won't consider it again
-
-			solution.sol[shuffled[i]] = true;
-			(solution.*CH)(p);
-			solution.sol[shuffled[i]] = false;
-
-			// Accept the first improvement
-			if (solution > *this) {
-				*this   = solution;
-				changed = true;
-				break;
-			}
+template<size_t W> void Solution<W>::toyoda(const problem& p) {
+	scoped_timer timer(counter::toyoda_ns);
+
+	thread_local toyoda_state state;
+	auto& [U, V, candidates, utility, tried, tree] = state;
+
+	const auto m = static_cast<size_t>(p.m);
+	const auto n = sol.size();
+
+	// Add A times a vector of m values to V
+	const auto update = [&](const double* u) {
+		double* __restrict v = V.data();
+		for (size_t j = 0; j < m; ++j) {
+			const double* __restrict column = std::assume_aligned<64>(p.A_t[j]);
+			const double             weight = u[j];
+			for (size_t i = 0; i < n; ++i) v[i] += column[i] * weight;
 		}
+	};
 
-		free(shuffled);
-	} while (changed);
-}
-
-/**
- * Update the solution with the best improvement iterative improvement algorithm
- * @param p
- * @param CH the constructive heuristic to use
- */
-void Solution::best_improvement(const problem& p, void (Solution::*CH)(const problem&)) {
-	// Keep improving until a local minimum is reached
-	bool changed;
-	do {
-		changed = false;
-		// Create the removal order
-		auto shuffled = create_shuffled(sol.size());
-		// Initialize the best neighbour so far
-		auto best = *this;
-
-		for (size_t i = 0; i < sol.size(); ++i) {
-			// Try to remove an item
-			if (!sol[shuffled[i]]) continue;
-			auto solution = *this;
-			solution.remove_unchecked(shuffled[i], p);
-
-			// Apply the constructive heuristic after removal
-			// The bool indicating the selection of the item is temporally set to true so the
-			// constructive heuristic won't consider it again
-			solution.sol[shuffled[i]] = true;
-			(solution.*CH)(p);
-			solution.sol[shuffled[i]] = false;
-
-			// Remember the best improvement
-			if (solution > best) {
-				best    = solution;
-				changed = true;
-			}
+	// Calculate U from the rows of the selected items and V, an empty solution weighs every
+	// resource the same
+	U.assign(padded(m), 0.0);
+	p.A.add_rows(sol, U.data());
+	bool zero = std::all_of(U.begin(), U.end(), [](double u) { return u == 0.0; });
+	if (zero) std::fill_n(U.begin(), m, 1.0);
+	V.assign(n, 0.0);
+	update(U.data());
+
+	candidates.clear();
+	for (size_t item = 0; item < n; ++item)
+		if (!sol[item]) candidates.push_back(item);
+
+	while (!candidates.empty()) {
+		// Calculate the pseudo-utility of the candidates
+		utility.resize(candidates.size());
+		for (size_t c = 0; c < candidates.size(); ++c)
+			utility[c] = static_cast<double>(p.profits[candidates[c]]) / V[candidates[c]];
+
+		// Insert the candidate with the highest pseudo-utility that fits
+		tree.build(utility.data(), utility.size());
+		tried.clear();
+		size_t c;
+		while ((c = tree.pop()) != tournament_tree::npos) {
+			tried.push_back(c);
+			if (add(candidates[c], p)) break;
 		}
+		if (c == tournament_tree::npos) break;
 
-		// Accept the best improvement
-		*this = best;
-
-		free(shuffled);
-	} while (changed);
-}
-
-/**
- * Update the solution with the variable neighborhood descent algorithm based on first improvement
- * @param p
- * @param CH the constructive heuristic to use
- */
-void Solution::variable_neighbourhood_descent(const problem& p,
-                                              void (Solution::*CH)(const problem&)) {
-	// Initialize the neighbourhood size
-	size_t k = 1;
-	// Keep improving until a local minimum is reached in every neighbourhood
-	while (k < 4) {
-		// Create the removal order
-		auto shuffled = create_shuffled(sol.size());
-		// Create the solution which will be transformed into a neighbour
-		auto solution = *this;
-
-		// Explore the current neighbourhood until the criterion is reached for the first time
-		bool found = explore_neighbourhood(solution, p, 0, k, shuffled, [&](Solution& solution) {
-			// Apply the constructive heuristic after removal of k items
-			(solution.*CH)(p);
-			// Check if it is an improvement
-			return solution > *this;
-		});
-
-		// If an improvement is found, return to the first neighbourhood, otherwise try the next one
-		if (found) {
-			*this = solution;
-			k     = 1;
-		} else {
-			++k;
+		// The weights of an empty U are replaced by the first inserted row that is not zero
+		const double* row = p.A[candidates[c]];
+		if (zero && std::any_of(row, row + m, [](double a) { return a != 0.0; })) {
+			zero = false;
+			V.assign(n, 0.0);
 		}
+		if (!zero) update(row);
 
-		free(shuffled);
+		// The inserted candidate and the ones that did not fit are done
+		for (auto t : tried) candidates[t] = UINT_MAX;
+		std::erase(candidates, UINT_MAX);
 	}
 }
 
-/**
- * Explore the neighbourhood of the solution of size k until the criterion is met for the first
- * time. All possible combinations of k item removals are tried through recursion.
- * @param solution the solution to start from and that will be modified
- * @param p
- * @param offset the offset in the removal order for the next item to be removed
- * @param k the amount of items that need to be removed
- * @param shuffled the removal order
- * @param criterion the criterion for choosing the new solution in the neighbourhood
- * @return the success of finding a matching neighbour
- */
-bool explore_neighbourhood(Solution& solution, const problem& p, size_t offset, const size_t k,
-                           const int* shuffled, const std::function<bool(Solution&)>& criterion) {
-	// No items are left to be removed
-	if (k == 0) {
-		// Apply the criterion and undo its changes to the solution if unsuccessful
-		// Return the success
-		auto orignal = solution;
-		bool success = criterion(solution);
-		if (!success) solution = orignal;
-		return success;
-	};
-
-	// More items must be removed recursively in order starting at the offset
-	for (; offset < solution.sol.size(); ++offset) {
-		// Try to remove one item
-		if (!solution.remove(shuffled[offset], p)) continue;
-
-		// Recursively remove the next k - 1 items starting from offset + 1
-		// The bool indicating the selection of the item is temporally set to true so the
-		// constructive heuristic won't consider it again
-		solution.sol[shuffled[offset]] = true;
-		bool found = explore_neighbourhood(solution, p, offset + 1, k - 1, shuffled, criterion);
-		solution.sol[shuffled[offset]] = false;
-
-		// Accept the first matching neighbour
-		if (found) return true;
-
-		// Otherwise, undo the removal and try removing the next item
-		solution.add(shuffled[offset], p);
-	}
-
-	return false;
-}
-
 /**
  * Validate whether the solution is a valid solution for the problem
  * This is only used for debugging purposes
  * @param p
  */
-void Solution::validate(const problem& p) const {
+template<size_t W> void Solution<W>::validate(const problem& p) const {
 	unsigned int v = 0;
 	Vector<int>  r(resources_used.size(), 0);
 
@@ -363,11 +315,16 @@ void Solution::validate(const problem& p) const {
 
 		v += p.profits[item];
 
-		for (size_t i = 0; i < r.size(); ++i) { r[i] += p.constraints[item][i]; }
+		const int* weights = p.constraints[item];
+		for (size_t i = 0; i < r.size(); ++i) { r[i] += weights[i]; }
 	}
 
 	assert(v == value);
 
+	uint64_t h = 0;
+	sol.for_each([&](size_t item) { h ^= p.zobrist[item]; });
+	assert(h == zobrist);
+
 	for (size_t i = 0; i < r.size(); ++i) {
 		assert(r[i] <= p.capacities[i]);
 		assert(r[i] == resources_used[i]);
@@ -379,7 +336,7 @@ void Solution::validate(const problem& p) const {
  * @param p
  * @return
  */
-bool Solution::invalid(const problem& p) const {
+template<size_t W> bool Solution<W>::invalid(const problem& p) const {
 	// Check the constraints
 	bool violated = false;
 	for (size_t i = 0; i < resources_used.size(); ++i) {
@@ -395,18 +352,13 @@ bool Solution::invalid(const problem& p) const {
  * Selects a random item present in the solution
  * @return
  */
-unsigned int Solution::random_item() const {
-	// Choose an index of a present item
-	auto index = std::rand() % size;
-
-	// Find the present item with this index
-	for (size_t item = 0; item < sol.size(); ++item) {
-		if (sol[item]) {
-			if (index == 0) return item;
-			else
-				--index;
-		}
-	}
+template<size_t W> unsigned int Solution<W>::random_item() const {
+	return selected[generator().below(selected.size())];
+}
+template class Solution<dynamic_width>;
+template class Solution<16>;
+template class Solution<32>;
 
-	return 0;
-}
\ No newline at end of file
+template std::ostream& operator<<(std::ostream& os, const Solution<dynamic_width>& solution);
+template std::ostream& operator<<(std::ostream& os, const Solution<16>& solution);
+template std::ostream& operator<<(std::ostream& os, const Solution<32>& solution);
@@ -5,42 +5,138 @@
 #ifndef MKP_SOLUTION_H
 #define MKP_SOLUTION_H
 
+#include "budget.h"
 #include "mkpproblem.h"
+#include "threads.h"
 
 #include <array>
-#include <functional>
 #include <iostream>
 #include <numeric>
 #include <optional>
+#include <type_traits>
 #include <vector>
 
-// Output style
-extern bool verbose;
+// Output style, per thread so every solve has its own
+extern thread_local bool verbose;
+// Where the search writes its verbose diagnostics, per thread like the style, none for nullptr
+extern thread_local std::ostream* diagnostics;
+
+// The resource width of the solution type that handles any number of knapsacks
+constexpr size_t dynamic_width = 0;
+
+template<size_t W> class Solution;
+
+template<size_t W> Solution<W> simulated_annealing(const problem& p, budget& b);
+
+struct simulated_annealing_sla;
+
+template<size_t W>
+Solution<W> parallel_annealing(const problem& p, const simulated_annealing_sla& sa, budget& b);
+
+template<size_t W> Solution<W> memetic_algorithm(const problem& p, size_t N, budget& b);
+
+struct memetic_sla;
+
+template<size_t W> Solution<W> island_model(const problem& p, const memetic_sla& ma, budget& b);
+
+struct tabu_search_sla;
+
+template<size_t W>
+Solution<W> tabu_search(const problem& p, const tabu_search_sla& ts, budget& b);
+
+template<size_t W> class tabu_state;
+
+template<size_t W>
+Solution<W> crossover(const Solution<W>& a, const Solution<W>& b, const problem& p);
 
 /**
  * Class containing a MKP solution
+ * @tparam W the padded number of knapsacks the solution is specialised for, the used resources
+ * are then stored inline and every resource loop has a constant trip count. dynamic_width handles
+ * any number of knapsacks.
  */
-class Solution {
+template<size_t W> class Solution {
+	// Inline storage for a fixed width, heap storage otherwise
+	using Resources = std::conditional_t<W == dynamic_width, Vector<int>, std::array<int, W>>;
+
 	// Profit of the solution
 	unsigned int value;
-	// Amount of selected items;
-	size_t size;
 	// Indication of the selected items
-	Vector<bool> sol;
-	// Count of the used resources
-	Vector<int> resources_used;
+	Bitset sol;
+	// The selected items in no particular order, and the index of every selected item in it
+	Vector<unsigned int> selected;
+	Vector<unsigned int> position;
+	// Zobrist hash of the selected items
+	uint64_t zobrist = 0;
+	// Count of the used resources, padded with zeros to the row stride of the constraints
+	alignas(W == dynamic_width ? alignof(Resources) : 64) Resources resources_used{};
+
+	// An add or remove of an item
+	struct move {
+		unsigned int item;
+		bool         added;
+	};
+
+	// The adds and removes since the last commit, so a neighbour can be evaluated in place and
+	// rolled back in O(changed items * m)
+	Vector<move> journal;
 
 	[[nodiscard]] std::pair<Vector<size_t>, Vector<size_t>> representation() const;
 
+	void select(size_t item, const problem& problem);
+
+	void deselect(size_t item, const problem& problem);
+
+	void include(size_t item, const problem& problem);
+
+	void exclude(size_t item, const problem& problem);
+
 	bool add(size_t item, const problem& problem);
 
 	bool remove(size_t item, const problem& problem);
 
 	void remove_unchecked(size_t item, const problem& problem);
 
-	friend bool explore_neighbourhood(Solution& solution, const problem& p, size_t offset, size_t k,
-	                                  const int*                            shuffled,
-	                                  const std::function<bool(Solution&)>& criterion);
+	/**
+	 * @return a checkpoint to roll back to
+	 */
+	[[nodiscard]] size_t checkpoint() const { return journal.size(); }
+
+	/**
+	 * Accept all changes since the last commit
+	 */
+	void commit() { journal.clear(); }
+
+	void rollback(const problem& problem, size_t checkpoint = 0);
+
+	void replay(const problem& problem, const Vector<move>& moves);
+
+	/**
+	 * Mark an unselected item as selected without including it, so the constructive heuristics
+	 * won't consider it
+	 * @param item
+	 */
+	void block(size_t item) { sol.set(item); }
+
+	/**
+	 * Undo block
+	 * @param item
+	 */
+	void unblock(size_t item) { sol.reset(item); }
+
+	template<class CH> void evaluate_removal(size_t item, const problem& p, CH ch);
+
+	template<class CH> void parallel_first_improvement(const problem& p, CH ch, thread_pool& pool);
+
+	template<class CH> void parallel_best_improvement(const problem& p, CH ch, thread_pool& pool);
+
+	template<class CH>
+	void parallel_variable_neighbourhood_descent(const problem& p, CH ch, bool deterministic,
+	                                             thread_pool& pool);
+
+	template<size_t V, class F>
+	friend bool explore_neighbourhood(Solution<V>& solution, const problem& p, size_t offset,
+	                                  size_t k, const int* shuffled, F&& criterion);
 
 	[[nodiscard]] unsigned int random_item() const;
 
@@ -48,10 +144,13 @@ class Solution {
 
 	void mutate(const problem& p);
 
-	friend Solution crossover(const Solution& a, const Solution& b, const problem& p);
+	template<size_t V>
+	friend Solution<V> crossover(const Solution<V>& a, const Solution<V>& b, const problem& p);
 
 public:
-	explicit Solution(const problem& p, void (Solution::*CH)(const problem&));
+	explicit Solution(const problem& p);
+
+	template<class CH> Solution(const problem& p, CH ch);
 
 	void random(const problem& p);
 
@@ -59,21 +158,55 @@ public:
 
 	void toyoda(const problem& p);
 
-	void first_improvement(const problem& p, void (Solution::*CH)(const problem&));
+	// The iterative improvement algorithms are defined in engine.h for every constructive
+	// heuristic tag CH
+
+	template<class CH> void first_improvement(const problem& p, CH ch);
+
+	template<class CH> void best_improvement(const problem& p, CH ch);
+
+	template<class CH>
+	void variable_neighbourhood_descent(const problem& p, CH ch, bool deterministic = true);
+
+	bool anneal(const problem& p, double T);
+
+	static Solution offspring(const Solution& a, const Solution& b, const problem& p);
+
+	/**
+	 * @return the total profit of the selected items
+	 */
+	[[nodiscard]] unsigned int profit() const { return value; }
 
-	void best_improvement(const problem& p, void (Solution::*CH)(const problem&));
+	/**
+	 * @return the selected items
+	 */
+	[[nodiscard]] const Bitset& items() const { return sol; }
 
-	void variable_neighbourhood_descent(const problem& p, void (Solution::*CH)(const problem&));
+	/**
+	 * @return the Zobrist hash of the selected items, equal solutions have equal hashes
+	 */
+	[[nodiscard]] uint64_t hash() const { return zobrist; }
 
 	bool invalid(const problem& p) const;
 
 	void validate(const problem& p) const;
 
-	friend std::ostream& operator<<(std::ostream& os, const Solution& solution);
+	template<size_t V>
+	friend std::ostream& operator<<(std::ostream& os, const Solution<V>& solution);
+
+	friend Solution simulated_annealing<W>(const problem& p, budget& b);
 
-	friend Solution simulated_annealing(const problem& p);
+	friend Solution parallel_annealing<W>(const problem& p, const simulated_annealing_sla& sa,
+	                                      budget& b);
 
-	friend Solution memetic_algorithm(const problem& p);
+	friend Solution memetic_algorithm<W>(const problem& p, size_t N, budget& b);
+
+	friend Solution tabu_search<W>(const problem& p, const tabu_search_sla& ts, budget& b);
+
+	friend class tabu_state<W>;
+
+	// The microbenchmarks in bench/microbench.cpp time the private kernels through it
+	friend struct kernel_access;
 
 	inline bool operator<(const Solution& s) const { return (value < s.value); }
 
@@ -94,8 +227,19 @@ public:
 	}
 };
 
-Solution simulated_annealing(const problem& p);
-
-Solution memetic_algorithm(const problem& p);
+/**
+ * Call a function with the resource width of the Solution specialisation for the problem:
+ * 16 for up to 16 knapsacks, 32 for up to 32 knapsacks and dynamic_width otherwise
+ * @param p
+ * @param f called with a std::integral_constant holding the width
+ * @return the result of f
+ */
+template<class F> decltype(auto) with_width(const problem& p, F&& f) {
+	switch (padded(p.m)) {
+	case 16: return f(std::integral_constant<size_t, 16>{});
+	case 32: return f(std::integral_constant<size_t, 32>{});
+	default: return f(std::integral_constant<size_t, dynamic_width>{});
+	}
+}
 
 #endif    // MKP_SOLUTION_H
@@ -0,0 +1,215 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "solver.h"
+#include "engine.h"
+#include "rng.h"
+#include "solution.h"
+#include "threads.h"
+
+#include <condition_variable>
+#include <thread>
+
+using namespace std::chrono;
+
+std::ostream& operator<<(std::ostream& os, const solution& s) {
+	if (!verbose) {
+		os << s.value;
+		return os;
+	}
+
+	std::vector<size_t> selected, discarded;
+	for (size_t item = 0; item < s.items.size(); ++item)
+		(s.items[item] ? selected : discarded).push_back(item);
+
+	if (selected.empty()) os << "No items selected in the solution!\n";
+	else {
+		os << "Items in solution:\n[ ";
+		for (const auto item : selected) { os << item << " "; }
+		os << "]\nSolution value: " << s.value << "\n";
+	}
+
+	os << "[ ";
+	for (const auto item : selected) { os << item << " "; }
+	os << "] :: [ ";
+	for (const auto item : discarded) { os << item << " "; }
+	os << "]\n\n";
+
+	return os;
+}
+
+/**
+ * @param s
+ * @return the solution independent of its resource width
+ */
+template<size_t W> static solution summarize(const Solution<W>& s) {
+	solution summary{ s.profit(), std::vector<bool>(s.items().size()) };
+	s.items().for_each([&](size_t item) { summary.items[item] = true; });
+	return summary;
+}
+
+/**
+ * Run the algorithms of the options with the solution type specialised for the resource width W.
+ * std::visit instantiates every combination once, so the search itself only contains direct
+ * calls.
+ * @tparam W
+ * @param p
+ * @param o
+ * @param b
+ * @return
+ */
+template<size_t W> static result run(const problem& p, const options& o, budget& b) {
+	result r;
+
+	if (!std::holds_alternative<std::monostate>(o.SLA)) {
+		std::visit(
+			[&](auto sla) {
+				if constexpr (!std::is_same_v<decltype(sla), std::monostate>) {
+					auto s = search<W>(p, sla, b);
+					s.validate(p);
+					r.best = summarize(s);
+				}
+			},
+			o.SLA);
+		return r;
+	}
+
+	std::visit(
+		[&](auto ch, auto ii) {
+			if constexpr (!std::is_same_v<decltype(ch), std::monostate>) {
+				auto s = Solution<W>(p, ch);
+				b.report(s.profit());
+
+				if constexpr (!std::is_same_v<decltype(ii), std::monostate>) {
+					r.constructed = summarize(s);
+					improve(s, p, ch, ii);
+					b.report(s.profit());
+				}
+				r.best = summarize(s);
+			}
+		},
+		o.CH, o.II);
+	return r;
+}
+
+/**
+ * Give every thread of a pool its own stream of a seed, the calling thread gets the first one
+ * @param pool
+ * @param seed
+ */
+static void seed_streams(thread_pool& pool, int seed) {
+	rng              streams(static_cast<uint64_t>(seed));
+	std::vector<rng> split;
+	for (size_t worker = 0; worker < pool.size(); ++worker) split.push_back(streams.split());
+	pool.run([&](size_t worker) { generator() = split[worker]; });
+}
+
+/**
+ * Check the options like build_problem checks a problem: a memetic algorithm needs individuals
+ * and generations between two migrations, simulated annealing steps between two exchanges
+ * @param o
+ * @return whether the algorithms of the options can run
+ */
+bool valid_options(const options& o) {
+	if (std::holds_alternative<std::monostate>(o.SLA) &&
+	    std::holds_alternative<std::monostate>(o.CH))
+		return false;
+
+	if (const auto* ma = std::get_if<memetic_sla>(&o.SLA))
+		if (ma->population == 0 || ma->interval == 0) return false;
+	if (const auto* sa = std::get_if<simulated_annealing_sla>(&o.SLA))
+		if (sa->interval == 0) return false;
+	return true;
+}
+
+/**
+ * The state of the calling thread a solve changes: the output style, the diagnostics, the random
+ * stream and the telemetry it counts into. They are restored when the solve returns or throws.
+ */
+class thread_state {
+	const bool          style  = verbose;
+	std::ostream* const log    = diagnostics;
+	const rng           stream = generator();
+
+public:
+	explicit thread_state(const options& o) {
+		verbose     = o.verbose;
+		diagnostics = o.verbose ? o.log : nullptr;
+	}
+
+	~thread_state() {
+		verbose     = style;
+		diagnostics = log;
+		generator() = stream;
+		telemetry::detach();
+	}
+
+	thread_state(const thread_state&)            = delete;
+	thread_state& operator=(const thread_state&) = delete;
+};
+
+std::optional<result> solve(const problem& p, const options& o) {
+	if (!valid_options(o)) return std::nullopt;
+
+	thread_state state(o);
+
+	// The pool and its threads belong to the solve
+	thread_pool pool(std::max<size_t>(o.threads, 1));
+	pool_scope  scope(pool);
+	seed_streams(pool, o.seed);
+
+	// The stochastic local search runs for the runtime of the instance unless told otherwise
+	auto limits = o.limits;
+	if (limits.time == milliseconds::max()) limits.time = seconds(p.runtime());
+
+	// The threads of the pool count into the telemetry
+	std::optional<telemetry> t;
+	if (o.stats) {
+		t.emplace(pool.size(), limits.time);
+		pool.run([&](size_t worker) { t->attach(worker); });
+	}
+
+	// Every new best value goes to the telemetry, the trace and the progress callback
+	std::optional<trace> tr;
+	if (o.on_incumbent)
+		tr.emplace(o.on_incumbent,
+		           o.best_known ? o.best_known : static_cast<unsigned int>(p.best_known));
+	auto on_progress = o.on_progress;
+	if (t || tr)
+		on_progress = [&](const progress& update) {
+			if (t) t->improvement(update);
+			if (tr) tr->push(update);
+			if (o.on_progress) o.on_progress(update);
+		};
+	budget b(limits, on_progress);
+
+	// Stream the telemetry from a thread of its own
+	std::jthread streamer;
+	if (t && o.on_stats && o.stats_interval > milliseconds::zero()) {
+		streamer = std::jthread([&](std::stop_token stop) {
+			std::mutex                  lock;
+			std::condition_variable_any wake;
+			std::unique_lock            guard(lock);
+			while (!wake.wait_for(guard, stop, o.stats_interval, [] { return false; }) &&
+			       !stop.stop_requested())
+				o.on_stats(t->report());
+		});
+	}
+
+	auto r  = with_width(p, [&](auto width) { return run<decltype(width)::value>(p, o, b); });
+	r.stats = { duration_cast<milliseconds>(b.elapsed()), b.iterations_spent(),
+		        b.evaluations_spent() };
+
+	if (tr)
+		tr->finish({ b.best(), r.stats.elapsed, r.stats.iterations, r.stats.evaluations });
+	if (streamer.joinable()) {
+		streamer.request_stop();
+		streamer.join();
+	}
+	if (t) {
+		r.telemetry = t->report();
+		pool.run([](size_t) { telemetry::detach(); });
+	}
+	return r;
+}
@@ -0,0 +1,61 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#ifndef MKP_SOLVER_H
+#define MKP_SOLVER_H
+
+#include "budget.h"
+#include "mkpproblem.h"
+#include "util.h"
+
+#include <chrono>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+/**
+ * A solution of a solve, independent of the resource width it was solved with
+ */
+struct solution {
+	unsigned int value = 0;
+	// Whether every item is selected
+	std::vector<bool> items;
+};
+
+// Output style of the calling thread, a solve sets it from its options while it runs
+extern thread_local bool verbose;
+
+// print a solution like a Solution: its value, or the selected and discarded items with verbose
+std::ostream& operator<<(std::ostream& os, const solution& s);
+
+/**
+ * What a solve has spent of its budget
+ */
+struct statistics {
+	std::chrono::milliseconds elapsed{};
+	uint64_t                  iterations  = 0;
+	uint64_t                  evaluations = 0;
+};
+
+struct result {
+	solution best;
+	// The solution of the constructive heuristic, when an iterative improvement algorithm followed
+	std::optional<solution> constructed;
+	statistics              stats;
+	// The telemetry of the search, when the options asked for it
+	std::optional<telemetry_report> telemetry;
+};
+
+// Whether the options select an algorithm and its parameters are valid: a memetic algorithm
+// needs a population and a migration interval of at least 1, simulated annealing an exchange
+// interval of at least 1
+bool valid_options(const options& o);
+
+// Solve a problem with the constructive heuristic and iterative improvement algorithm of the
+// options, or with their stochastic local search algorithm. Returns nothing when the options are
+// not valid. A solve only uses state of its own, so solves can run concurrently on any number of
+// threads.
+std::optional<result> solve(const problem& p, const options& o);
+
+#endif    // MKP_SOLVER_H
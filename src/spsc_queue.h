@@ -0,0 +1,65 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#ifndef MKP_SPSC_QUEUE_H
+#define MKP_SPSC_QUEUE_H
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+/**
+ * Bounded lock-free queue for one producer thread and one consumer thread. Neither side ever
+ * blocks: a push to a full queue and a pop from an empty queue fail instead.
+ * @tparam T
+ */
+template<class T> class spsc_queue {
+	std::unique_ptr<std::optional<T>[]> slots;
+	size_t                              mask;
+
+	// The next slot to pop, written by the consumer only
+	alignas(64) std::atomic<size_t> head = 0;
+	// The next slot to push, written by the producer only
+	alignas(64) std::atomic<size_t> tail = 0;
+
+public:
+	/**
+	 * @param capacity rounded up to a power of two
+	 */
+	explicit spsc_queue(size_t capacity):
+		slots(new std::optional<T>[std::bit_ceil(capacity)]), mask(std::bit_ceil(capacity) - 1) {}
+
+	spsc_queue(const spsc_queue&)            = delete;
+	spsc_queue& operator=(const spsc_queue&) = delete;
+
+	/**
+	 * Push an element, called by the producer only
+	 * @param value
+	 * @return false if the queue is full, the value is then dropped
+	 */
+	bool try_push(T value) {
+		const size_t t = tail.load(std::memory_order_relaxed);
+		if (t - head.load(std::memory_order_acquire) > mask) return false;
+		slots[t & mask].emplace(std::move(value));
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * Pop an element, called by the consumer only
+	 * @return the oldest element, or nothing if the queue is empty
+	 */
+	std::optional<T> try_pop() {
+		const size_t h = head.load(std::memory_order_relaxed);
+		if (h == tail.load(std::memory_order_acquire)) return std::nullopt;
+		std::optional<T> value = std::move(slots[h & mask]);
+		slots[h & mask].reset();
+		head.store(h + 1, std::memory_order_release);
+		return value;
+	}
+};
+
+#endif    // MKP_SPSC_QUEUE_H
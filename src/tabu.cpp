@@ -0,0 +1,257 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "budget.h"
+#include "engine.h"
+#include "rng.h"
+#include "solution.h"
+#include "tabu.h"
+#include "util.h"
+
+#include <algorithm>
+
+/**
+ * Whether an item fits in the room left in the knapsacks: every lane of its weights is at most
+ * the room, the padding lanes are zero in both
+ * @tparam L the padded number of knapsacks, dynamic_width for a width only known at runtime
+ * @param room the capacities minus the used resources, plus the weights of the items dropped
+ * @param weights
+ * @param width the padded number of knapsacks when L is dynamic_width
+ * @return
+ */
+template<size_t L> static bool fits(const int* room, const int* weights, size_t width) {
+	const size_t lanes    = L == dynamic_width ? width : L;
+	int          violated = 0;
+	for (size_t i = 0; i < lanes; ++i) violated |= weights[i] > room[i];
+	return !violated;
+}
+
+template<size_t W>
+tabu_state<W>::tabu_state(const problem& p, Solution<W> start, size_t tenure):
+	p(p), m(static_cast<size_t>(p.m)), width(padded(m)), tenure(std::max<size_t>(tenure, 1)),
+	current(std::move(start)), tabu(current.sol.size(), 0), rank(current.sol.size()),
+	slack(width), room(width), blocker(current.sol.size(), m) {
+	in.reserve(rank.size());
+	out.reserve(rank.size());
+	for (size_t r = 0; r < rank.size(); ++r) rank[p.greedy_order[r]] = static_cast<unsigned int>(r);
+	rebuild();
+}
+
+/**
+ * @param item
+ * @return a knapsack the item is heavier than the slack of, m when it fits on its own
+ */
+template<size_t W> size_t tabu_state<W>::blocking(size_t item) const {
+	const int* weights = p.constraints[item];
+	for (size_t i = 0; i < m; ++i)
+		if (weights[i] > slack[i]) return i;
+	return m;
+}
+
+/**
+ * Build the ordered items, the slack and the blocking knapsacks of the current solution from
+ * scratch
+ */
+template<size_t W> void tabu_state<W>::rebuild() {
+	in.clear();
+	out.clear();
+	for (auto item : p.greedy_order) (current.sol[item] ? in : out).push_back(item);
+	std::reverse(in.begin(), in.end());
+
+	for (size_t i = 0; i < width; ++i) slack[i] = p.capacities[i] - current.resources_used[i];
+	for (auto k : out) blocker[k] = blocking(k);
+}
+
+template<size_t W> void tabu_state<W>::reset(const Solution<W>& s) {
+	current = s;
+	rebuild();
+}
+
+template<size_t W> void tabu_state<W>::forget() { std::fill(tabu.begin(), tabu.end(), 0); }
+
+/**
+ * Flip an item and update the slack and the ordered items, the item becomes tabu
+ * @param item
+ * @param iteration
+ */
+template<size_t W> void tabu_state<W>::flip(unsigned int item, uint64_t iteration) {
+	const auto increasing = [&](unsigned int a, unsigned int b) { return rank[a] > rank[b]; };
+	const auto decreasing = [&](unsigned int a, unsigned int b) { return rank[a] < rank[b]; };
+	const int* weights    = p.constraints[item];
+	if (current.sol[item]) {
+		current.exclude(item, p);
+		in.erase(std::lower_bound(in.begin(), in.end(), item, increasing));
+		out.insert(std::lower_bound(out.begin(), out.end(), item, decreasing), item);
+		for (size_t i = 0; i < width; ++i) slack[i] += weights[i];
+	} else {
+		current.include(item, p);
+		out.erase(std::lower_bound(out.begin(), out.end(), item, decreasing));
+		in.insert(std::lower_bound(in.begin(), in.end(), item, increasing), item);
+		for (size_t i = 0; i < width; ++i) slack[i] -= weights[i];
+	}
+	tabu[item] = iteration + tenure + generator().below(tenure);
+}
+
+/**
+ * Test the items whose fit can change with the slack again: the items that fit when the slack
+ * shrank, and the items whose blocking knapsack got room when it grew
+ * @param grown
+ * @param shrunk
+ */
+template<size_t W> void tabu_state<W>::refit(bool grown, bool shrunk) {
+	for (auto k : out) {
+		if (blocker[k] == m) {
+			if (shrunk) blocker[k] = blocking(k);
+		} else if (grown && p.constraints[k][blocker[k]] <= slack[blocker[k]]) {
+			blocker[k] = blocking(k);
+		}
+	}
+}
+
+/**
+ * Every move costs one O(m) feasibility check and no solution is copied: the scan of a dropped
+ * item stops at the first feasible admissible item to add, or as soon as no item can beat the
+ * best move found. An add is only scored for the items that fit on their own, a swap is never
+ * needed for them.
+ */
+template<size_t W>
+typename tabu_state<W>::move tabu_state<W>::choose(uint64_t iteration, long record,
+                                                   uint64_t& scored) {
+	const long value   = current.value;
+	const auto is_tabu = [&](size_t item) { return tabu[item] > iteration; };
+
+	move     chosen;
+	uint64_t count = 0;
+	// Take a move if it beats the chosen one and is not tabu or aspirated
+	const auto consider = [&](move candidate, bool forbidden) {
+		++count;
+		if (candidate.delta <= chosen.delta) return false;
+		if (forbidden && value + candidate.delta <= record) return false;
+		candidate.aspirated = forbidden;
+		chosen              = candidate;
+		return true;
+	};
+
+	// Add the most profitable item that fits
+	for (auto k : out)
+		if (blocker[k] == m && consider({ {}, 0, k, profit(k), false }, is_tabu(k))) break;
+
+	// Drop the least profitable item
+	for (auto j : in)
+		if (consider({ { j }, 1, std::nullopt, -profit(j), false }, is_tabu(j))) break;
+
+	// Swap an item in the solution for an item out of it
+	const long most = out.empty() ? LONG_MIN : profit(out.front());
+	for (auto j : in) {
+		if (most - profit(j) <= chosen.delta) break;
+		const int* w_j = p.constraints[j];
+		for (size_t i = 0; i < width; ++i) room[i] = slack[i] + w_j[i];
+
+		for (auto k : out) {
+			const long delta = profit(k) - profit(j);
+			if (delta <= chosen.delta) break;
+			if (blocker[k] == m) continue;
+			if (fits<W>(room.data(), p.constraints[k], width) &&
+			    consider({ { j }, 1, k, delta, false }, is_tabu(j) || is_tabu(k)))
+				break;
+		}
+	}
+
+	// Swap two items in the solution for an item out of it
+	for (size_t a = 0; a + 1 < in.size(); ++a) {
+		const auto j1 = in[a];
+		if (most - profit(j1) - profit(in[a + 1]) <= chosen.delta) break;
+
+		for (size_t c = a + 1; c < in.size(); ++c) {
+			const auto j2 = in[c];
+			if (most - profit(j1) - profit(j2) <= chosen.delta) break;
+			const int* w_1 = p.constraints[j1];
+			const int* w_2 = p.constraints[j2];
+			for (size_t i = 0; i < width; ++i) room[i] = slack[i] + w_1[i] + w_2[i];
+
+			for (auto k : out) {
+				const long delta = profit(k) - profit(j1) - profit(j2);
+				if (delta <= chosen.delta) break;
+				if (fits<W>(room.data(), p.constraints[k], width) &&
+				    consider({ { j1, j2 }, 2, k, delta, false },
+				             is_tabu(j1) || is_tabu(j2) || is_tabu(k)))
+					break;
+			}
+		}
+	}
+
+	scored += count;
+	return chosen;
+}
+
+template<size_t W> void tabu_state<W>::apply(const move& chosen, uint64_t iteration) {
+	for (size_t d = 0; d < chosen.drops; ++d) flip(chosen.dropped[d], iteration);
+	if (chosen.added) flip(*chosen.added, iteration);
+	refit(chosen.drops > 0, chosen.added.has_value());
+	for (size_t d = 0; d < chosen.drops; ++d)
+		blocker[chosen.dropped[d]] = blocking(chosen.dropped[d]);
+}
+
+template class tabu_state<dynamic_width>;
+template class tabu_state<16>;
+template class tabu_state<32>;
+
+/**
+ * Tabu search with add, drop, 1-1 swap and 2-1 swap moves, starting from Toyoda.
+ * Every iteration scores the whole neighbourhood against the slack of the knapsacks kept by
+ * tabu_state. The best admissible move is applied in place, even when it worsens the solution.
+ * The items it flips stay tabu for a random number of iterations in [tenure, 2 * tenure): an item
+ * that was dropped cannot be added and an item that was added cannot be dropped, unless the move
+ * reaches a value above the best one found (aspiration). After n moves without a new best solution
+ * the search returns to the best one, the random tenures then lead it elsewhere.
+ * @param p
+ * @param ts
+ * @param b the budget, every move is an iteration
+ * @return the best solution visited
+ */
+template<size_t W>
+Solution<W> tabu_search(const problem& p, const tabu_search_sla& ts, budget& b) {
+	b.spend(0, 1);
+	tabu_state<W> state(p, Solution<W>(p, toyoda_ch{}), ts.tenure);
+	Solution<W>   best = state.solution();
+	b.report(best.value);
+
+	const size_t n = best.sol.size();
+	// The moves since the best solution improved
+	size_t since = 0;
+
+	for (uint64_t iteration = 1; b.spend(1, 1); ++iteration) {
+		uint64_t   scored = 0;
+		const auto chosen = state.choose(iteration, best.value, scored);
+		tally(counter::tabu_neighbours, scored);
+		if (chosen.delta == LONG_MIN) {
+			// Every move is tabu, forget them
+			state.forget();
+			continue;
+		}
+
+		// Apply the move in place and make the flipped items tabu
+		state.apply(chosen, iteration);
+		tally(counter::tabu_moves);
+		if (chosen.aspirated) tally(counter::aspirations);
+
+		const auto& current = state.solution();
+		b.report(current.value);
+		if (current > best) {
+			best  = current;
+			since = 0;
+		} else if (++since >= n) {
+			// Intensify: the moves ranked by profit alone drift away from the best solution
+			state.reset(best);
+			since = 0;
+		}
+	}
+
+	return best;
+}
+
+template Solution<dynamic_width> tabu_search(const problem& p, const tabu_search_sla& ts,
+                                             budget& b);
+template Solution<16> tabu_search(const problem& p, const tabu_search_sla& ts, budget& b);
+template Solution<32> tabu_search(const problem& p, const tabu_search_sla& ts, budget& b);
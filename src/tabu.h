@@ -0,0 +1,102 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#ifndef MKP_TABU_H
+#define MKP_TABU_H
+
+#include "solution.h"
+
+#include <array>
+#include <climits>
+#include <optional>
+
+/**
+ * The current solution of the tabu search and everything its moves are scored against: the slack
+ * of the knapsacks, the items in the solution by increasing profit and the items out of it by
+ * decreasing profit, both in the greedy order, and the iteration until which every item is tabu.
+ * Every item out of the solution keeps a knapsack it is too heavy for, or m when it fits on its
+ * own. All of it is kept across moves: a flip moves its item between the ordered lists, and after
+ * a move only the items whose fit can change are tested again.
+ * @tparam W
+ */
+template<size_t W> class tabu_state {
+public:
+	/**
+	 * A move: drop up to two items from the solution and add up to one
+	 */
+	struct move {
+		std::array<unsigned int, 2> dropped{};
+		size_t                      drops = 0;
+		std::optional<unsigned int> added;
+		long                        delta = LONG_MIN;
+		// Whether the move is tabu and only allowed since it reaches a new best value
+		bool aspirated = false;
+	};
+
+private:
+	const problem& p;
+	size_t         m;
+	size_t         width;
+	size_t         tenure;
+	Solution<W>    current;
+
+	Vector<uint64_t>     tabu;
+	Vector<unsigned int> in, out, rank;
+	Vector<int>          slack, room;
+	Vector<size_t>       blocker;
+
+	[[nodiscard]] long profit(size_t item) const { return p.profits[item]; }
+
+	[[nodiscard]] size_t blocking(size_t item) const;
+
+	void flip(unsigned int item, uint64_t iteration);
+
+	void refit(bool grown, bool shrunk);
+
+	void rebuild();
+
+public:
+	/**
+	 * @param p
+	 * @param start the initial solution
+	 * @param tenure a flipped item stays tabu for a random number of iterations in
+	 * [tenure, 2 * tenure)
+	 */
+	tabu_state(const problem& p, Solution<W> start, size_t tenure);
+
+	[[nodiscard]] const Solution<W>& solution() const { return current; }
+
+	/**
+	 * Return to a solution, the tabu iterations are kept
+	 * @param s
+	 */
+	void reset(const Solution<W>& s);
+
+	/**
+	 * Score the add, drop, 1-1 swap and 2-1 swap neighbourhood and choose the best admissible move:
+	 * a move that flips a tabu item is only admissible when it reaches a value above the record
+	 * @param iteration
+	 * @param record the best value found
+	 * @param scored incremented by the number of moves scored
+	 * @return the move, with a delta of LONG_MIN when no move is admissible
+	 */
+	move choose(uint64_t iteration, long record, uint64_t& scored);
+
+	/**
+	 * Apply a move in place, its items become tabu
+	 * @param chosen
+	 * @param iteration
+	 */
+	void apply(const move& chosen, uint64_t iteration);
+
+	/**
+	 * Forget every tabu item
+	 */
+	void forget();
+
+	// tests/tabu_test.cpp checks the incremental state against a full recompute through it
+	friend struct kernel_access;
+};
+
+#endif    // MKP_TABU_H
@@ -0,0 +1,132 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "telemetry.h"
+
+using namespace std::chrono;
+
+telemetry::telemetry(size_t threads, milliseconds time_limit):
+	slots(std::make_unique<slot[]>(threads)), size(threads), start(steady_clock::now()),
+	time_limit(time_limit) {}
+
+void telemetry::attach([[maybe_unused]] size_t worker) {
+#ifdef MKP_TELEMETRY
+	tallies  = slots[worker].values.data();
+	recorder = this;
+#endif
+}
+
+void telemetry::detach() {
+#ifdef MKP_TELEMETRY
+	tallies  = nullptr;
+	recorder = nullptr;
+#endif
+}
+
+void telemetry::temperature([[maybe_unused]] double T, [[maybe_unused]] uint64_t neighbours,
+                            [[maybe_unused]] uint64_t accepted) {
+#ifdef MKP_TELEMETRY
+	auto* t = recorder;
+	if (!t) return;
+	const auto      elapsed = duration_cast<milliseconds>(steady_clock::now() - t->start);
+	std::lock_guard guard(t->lock);
+	t->temperatures.push_back({ elapsed, T, neighbours, accepted });
+#endif
+}
+
+void telemetry::replica([[maybe_unused]] const replica_rates& rates) {
+#ifdef MKP_TELEMETRY
+	auto* t = recorder;
+	if (!t) return;
+	std::lock_guard guard(t->lock);
+	t->replicas.push_back(rates);
+#endif
+}
+
+void telemetry::improvement(const progress& update) {
+	std::lock_guard guard(lock);
+	improvements.push_back(update);
+}
+
+telemetry_report telemetry::report() const {
+	telemetry_report r;
+	r.elapsed    = duration_cast<milliseconds>(steady_clock::now() - start);
+	r.time_limit = time_limit;
+	for (size_t worker = 0; worker < size; ++worker)
+		for (size_t c = 0; c < counters; ++c)
+			r.counts[c] += slots[worker].values[c].load(std::memory_order_relaxed);
+
+	std::lock_guard guard(lock);
+	r.temperatures = temperatures;
+	r.replicas     = replicas;
+	r.improvements = improvements;
+	return r;
+}
+
+/**
+ * @param part
+ * @param whole
+ * @return part / whole, 0 when whole is 0
+ */
+static double ratio(double part, double whole) { return whole > 0 ? part / whole : 0; }
+
+std::ostream& write_json(std::ostream& os, const telemetry_report& report) {
+	const auto seconds = static_cast<double>(report.elapsed.count()) / 1000;
+	const auto count   = [&](counter c) { return static_cast<double>(report[c]); };
+	const auto ms      = [&](counter c) { return count(c) / 1e6; };
+
+	// The neighbours evaluated are the steps, the offspring and the moves scored by tabu search
+	const auto neighbours =
+		count(counter::steps) + count(counter::generations) + count(counter::tabu_neighbours);
+
+	os << "{\"elapsed_ms\": " << report.elapsed.count()
+	   << ", \"time_limit_ms\": " << report.time_limit.count()
+	   << ", \"neighbours_per_second\": " << ratio(neighbours, seconds)
+	   << ", \"steps\": " << report[counter::steps]
+	   << ", \"accepted\": " << report[counter::accepted] << ", \"acceptance_rate\": "
+	   << ratio(count(counter::accepted), count(counter::steps))
+	   << ", \"generations\": " << report[counter::generations]
+	   << ", \"duplicates\": " << report[counter::duplicates]
+	   << ", \"duplicate_rate\": "
+	   << ratio(count(counter::duplicates), count(counter::generations))
+	   << ", \"repair\": {\"drops\": " << report[counter::repair_drops]
+	   << ", \"adds\": " << report[counter::repair_adds] << "}"
+	   << ", \"tabu\": {\"moves\": " << report[counter::tabu_moves]
+	   << ", \"neighbours\": " << report[counter::tabu_neighbours]
+	   << ", \"aspirations\": " << report[counter::aspirations] << "}"
+	   << ", \"time_ms\": {\"toyoda\": " << ms(counter::toyoda_ns)
+	   << ", \"repair\": " << ms(counter::repair_ns)
+	   << ", \"crossover\": " << ms(counter::crossover_ns) << "}";
+
+	os << ", \"temperatures\": [";
+	for (size_t i = 0; i < report.temperatures.size(); ++i) {
+		const auto& step = report.temperatures[i];
+		os << (i ? ", " : "") << "{\"elapsed_ms\": " << step.elapsed.count()
+		   << ", \"T\": " << step.T << ", \"neighbours\": " << step.neighbours
+		   << ", \"acceptance_rate\": "
+		   << ratio(static_cast<double>(step.accepted), static_cast<double>(step.neighbours))
+		   << "}";
+	}
+
+	os << "], \"replicas\": [";
+	for (size_t i = 0; i < report.replicas.size(); ++i) {
+		const auto& r = report.replicas[i];
+		os << (i ? ", " : "") << "{\"T\": " << r.T << ", \"steps\": " << r.steps
+		   << ", \"acceptance_rate\": "
+		   << ratio(static_cast<double>(r.accepted), static_cast<double>(r.steps))
+		   << ", \"exchanges\": " << r.answered << ", \"exchange_rate\": "
+		   << ratio(static_cast<double>(r.exchanged), static_cast<double>(r.answered)) << "}";
+	}
+
+	os << "], \"improvements\": [";
+	for (size_t i = 0; i < report.improvements.size(); ++i) {
+		const auto& update = report.improvements[i];
+		os << (i ? ", " : "") << "{\"elapsed_ms\": " << update.elapsed.count()
+		   << ", \"value\": " << update.value << ", \"iterations\": " << update.iterations
+		   << ", \"evaluations\": " << update.evaluations << "}";
+	}
+	os << "]}";
+
+	return os;
+}
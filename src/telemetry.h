@@ -0,0 +1,203 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#ifndef MKP_TELEMETRY_H
+#define MKP_TELEMETRY_H
+
+#include "budget.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+// The counters and timers of the search
+enum class counter : size_t {
+	// Steps of simulated annealing and the accepted ones
+	steps,
+	accepted,
+	// Generations of the memetic algorithm, one offspring each
+	generations,
+	// Offspring rejected because they already are in the population
+	duplicates,
+	// Items removed and added by repair
+	repair_drops,
+	repair_adds,
+	// Moves of tabu search, the neighbours it scored and the tabu moves taken by aspiration
+	tabu_moves,
+	tabu_neighbours,
+	aspirations,
+	// Nanoseconds spent in Toyoda, repair and crossover
+	toyoda_ns,
+	repair_ns,
+	crossover_ns,
+	count
+};
+
+constexpr size_t counters = static_cast<size_t>(counter::count);
+
+/**
+ * The temperature of simulated annealing during one step of the schedule
+ */
+struct temperature_step {
+	std::chrono::milliseconds elapsed;
+	double                    T;
+	uint64_t                  neighbours;
+	uint64_t                  accepted;
+};
+
+/**
+ * A replica of parallel simulated annealing at the end of its run
+ */
+struct replica_rates {
+	double   T;
+	uint64_t steps;
+	uint64_t accepted;
+	// Offers of the colder replica above that it answered, and the accepted ones
+	uint64_t answered;
+	uint64_t exchanged;
+};
+
+/**
+ * The telemetry of a solve so far
+ */
+struct telemetry_report {
+	std::chrono::milliseconds      elapsed{};
+	std::chrono::milliseconds      time_limit{};
+	std::array<uint64_t, counters> counts{};
+	std::vector<temperature_step>  temperatures;
+	std::vector<replica_rates>     replicas;
+	std::vector<progress>          improvements;
+
+	[[nodiscard]] uint64_t operator[](counter c) const { return counts[static_cast<size_t>(c)]; }
+};
+
+// write a report as one line of JSON
+std::ostream& write_json(std::ostream& os, const telemetry_report& report);
+
+/**
+ * The telemetry of one solve. Every thread of the solve counts into a slot of its own, a cache
+ * line apart, with relaxed loads and stores, so counting costs about as much as a plain increment
+ * and a report can be taken from any thread while the solve runs.
+ * The hot paths count through tally() and scoped_timer, which do nothing on a thread that is not
+ * attached to a telemetry, and compile away without MKP_TELEMETRY.
+ */
+class telemetry {
+	struct alignas(64) slot {
+		std::array<std::atomic<uint64_t>, counters> values{};
+	};
+
+	std::unique_ptr<slot[]>               slots;
+	size_t                                size;
+	std::chrono::steady_clock::time_point start;
+	std::chrono::milliseconds             time_limit;
+
+	mutable std::mutex            lock;
+	std::vector<temperature_step> temperatures;
+	std::vector<replica_rates>    replicas;
+	std::vector<progress>         improvements;
+
+public:
+	/**
+	 * Start the clock
+	 * @param threads the threads that may attach
+	 * @param time_limit the wall time of the solve, reported to relate the counts to the budget
+	 */
+	telemetry(size_t threads, std::chrono::milliseconds time_limit);
+
+	telemetry(const telemetry&)            = delete;
+	telemetry& operator=(const telemetry&) = delete;
+
+	/**
+	 * Let the calling thread count into a slot, until it detaches
+	 * @param worker the index of the thread in the pool of the solve
+	 */
+	void attach(size_t worker);
+
+	/**
+	 * Stop counting on the calling thread
+	 */
+	static void detach();
+
+	/**
+	 * Record a step of the annealing schedule of the telemetry the calling thread is attached to
+	 * @param T
+	 * @param neighbours evaluated at T
+	 * @param accepted of them
+	 */
+	static void temperature(double T, uint64_t neighbours, uint64_t accepted);
+
+	/**
+	 * Record the rates of a replica of parallel simulated annealing of the telemetry the calling
+	 * thread is attached to
+	 * @param rates
+	 */
+	static void replica(const replica_rates& rates);
+
+	/**
+	 * Record a new best value
+	 * @param update
+	 */
+	void improvement(const progress& update);
+
+	/**
+	 * @return the counts of all threads and the records so far
+	 */
+	[[nodiscard]] telemetry_report report() const;
+};
+
+#ifdef MKP_TELEMETRY
+// The counters of the calling thread and its telemetry, nullptr when it is not attached
+inline constinit thread_local std::atomic<uint64_t>* tallies  = nullptr;
+inline constinit thread_local telemetry*             recorder = nullptr;
+
+/**
+ * Count on the calling thread
+ * @param c
+ * @param n
+ */
+inline void tally(counter c, uint64_t n = 1) {
+	if (auto* values = tallies) {
+		auto& value = values[static_cast<size_t>(c)];
+		value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+	}
+}
+
+/**
+ * Count the nanoseconds of a scope on the calling thread
+ */
+class scoped_timer {
+	counter                               c;
+	std::chrono::steady_clock::time_point start;
+
+public:
+	explicit scoped_timer(counter c): c(c) {
+		if (tallies) start = std::chrono::steady_clock::now();
+	}
+
+	~scoped_timer() {
+		if (tallies)
+			tally(c, static_cast<uint64_t>(
+						 std::chrono::duration_cast<std::chrono::nanoseconds>(
+							 std::chrono::steady_clock::now() - start)
+							 .count()));
+	}
+
+	scoped_timer(const scoped_timer&)            = delete;
+	scoped_timer& operator=(const scoped_timer&) = delete;
+};
+#else
+inline void tally(counter, uint64_t = 1) {}
+
+class scoped_timer {
+public:
+	explicit scoped_timer(counter) {}
+};
+#endif
+
+#endif    // MKP_TELEMETRY_H
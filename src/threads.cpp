@@ -0,0 +1,120 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "threads.h"
+
+
+/**
+ * Start size - 1 worker threads
+ * @param size the number of workers including the calling thread, at least 1
+ */
+thread_pool::thread_pool(size_t size) {
+	for (size_t worker = 1; worker < size; ++worker)
+		workers.emplace_back(&thread_pool::work, this, worker);
+}
+
+thread_pool::~thread_pool() {
+	{
+		std::lock_guard lock(mutex);
+		quit = true;
+	}
+	started.notify_all();
+	for (auto& worker : workers) worker.join();
+}
+
+/**
+ * Wait for jobs and run them until the pool is destroyed
+ * @param worker the index of this worker
+ */
+void thread_pool::work(size_t worker) {
+	size_t seen = 0;
+	while (true) {
+		{
+			std::unique_lock lock(mutex);
+			started.wait(lock, [&] { return quit || generation != seen; });
+			if (quit) return;
+			seen = generation;
+		}
+
+		job(context, worker);
+
+		std::lock_guard lock(mutex);
+		if (--pending == 0) finished.notify_one();
+	}
+}
+
+/**
+ * Hand a job to every worker, run it as worker 0 and wait for the others
+ * @param job
+ * @param context
+ */
+void thread_pool::dispatch(void (*job)(void*, size_t), void* context) {
+	{
+		std::lock_guard lock(mutex);
+		this->job     = job;
+		this->context = context;
+		pending       = workers.size();
+		++generation;
+	}
+	started.notify_all();
+
+	job(context, 0);
+
+	std::unique_lock lock(mutex);
+	finished.wait(lock, [&] { return pending == 0; });
+}
+
+/**
+ * Take the next task of a worker, or steal the upper half of the tasks of the first other worker
+ * that has any left
+ * @param ranges the remaining tasks of every worker
+ * @param worker
+ * @param task the task to run
+ * @return false if no tasks are left anywhere
+ */
+bool thread_pool::next_task(std::vector<task_range>& ranges, size_t worker, size_t& task) {
+	auto& own = ranges[worker];
+	{
+		std::lock_guard lock(own.mutex);
+		if (own.begin < own.end) {
+			task = own.begin++;
+			return true;
+		}
+	}
+
+	for (size_t i = 1; i < ranges.size(); ++i) {
+		auto&  victim = ranges[(worker + i) % ranges.size()];
+		size_t begin, end;
+		{
+			std::lock_guard lock(victim.mutex);
+			if (victim.begin == victim.end) continue;
+			end        = victim.end;
+			begin      = victim.begin + (victim.end - victim.begin) / 2;
+			victim.end = begin;
+		}
+
+		// Run the first stolen task and keep the rest, only this worker adds to its own range
+		std::lock_guard lock(own.mutex);
+		task      = begin;
+		own.begin = begin + 1;
+		own.end   = end;
+		return true;
+	}
+
+	return false;
+}
+
+// The pool of the innermost pool_scope of this thread
+static thread_local thread_pool* scoped = nullptr;
+
+thread_pool& threads() {
+	if (scoped) return *scoped;
+	// Outside a scope the calling thread runs everything itself, a pool of size 1 has no threads
+	static thread_local thread_pool serial(1);
+	return serial;
+}
+
+pool_scope::pool_scope(thread_pool& pool): previous(scoped) { scoped = &pool; }
+
+pool_scope::~pool_scope() { scoped = previous; }
@@ -0,0 +1,113 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#ifndef MKP_THREADS_H
+#define MKP_THREADS_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Fixed pool of worker threads for fork-join parallelism. The calling thread takes part as
+ * worker 0, so a pool of size 1 runs everything inline without any synchronisation.
+ */
+class thread_pool {
+	std::vector<std::thread> workers;
+
+	std::mutex              mutex;
+	std::condition_variable started;
+	std::condition_variable finished;
+
+	// The current job, called once by every worker with its index
+	void (*job)(void* context, size_t worker) = nullptr;
+	void* context                             = nullptr;
+	// Incremented for every job so the workers can tell a new job from a spurious wake-up
+	size_t generation = 0;
+	// Workers that have not finished the current job yet
+	size_t pending = 0;
+	bool   quit    = false;
+
+	void work(size_t worker);
+
+	void dispatch(void (*job)(void*, size_t), void* context);
+
+	// The tasks a worker has left in a work-stealing run, [begin, end)
+	struct alignas(64) task_range {
+		std::mutex mutex;
+		size_t     begin = 0;
+		size_t     end   = 0;
+	};
+
+	static bool next_task(std::vector<task_range>& ranges, size_t worker, size_t& task);
+
+public:
+	explicit thread_pool(size_t size);
+
+	~thread_pool();
+
+	thread_pool(const thread_pool&)            = delete;
+	thread_pool& operator=(const thread_pool&) = delete;
+
+	/**
+	 * @return the number of workers, including the calling thread
+	 */
+	[[nodiscard]] size_t size() const { return workers.size() + 1; }
+
+	/**
+	 * Call f(worker) on every worker in parallel and return when all calls have returned
+	 * @tparam F
+	 * @param f
+	 */
+	template<class F> void run(F&& f) {
+		if (workers.empty()) return f(size_t{ 0 });
+		using Job = std::remove_reference_t<F>;
+		dispatch([](void* erased, size_t worker) { (*static_cast<Job*>(erased))(worker); }, &f);
+	}
+
+	/**
+	 * Call f(worker, task) for every task in [0, count) on the workers in parallel with work
+	 * stealing. Every worker starts with a contiguous block of tasks and runs its own tasks in
+	 * increasing order, a worker without tasks steals the upper half of the tasks of another one.
+	 * @tparam F
+	 * @param count
+	 * @param f
+	 */
+	template<class F> void run_stealing(size_t count, F&& f) {
+		std::vector<task_range> ranges(size());
+		for (size_t w = 0; w < size(); ++w) {
+			ranges[w].begin = count * w / size();
+			ranges[w].end   = count * (w + 1) / size();
+		}
+
+		run([&](size_t worker) {
+			for (size_t task; next_task(ranges, worker, task);) f(worker, task);
+		});
+	}
+};
+
+// the thread pool of the local search algorithms: the pool of the innermost pool_scope of the
+// calling thread, or a pool of the calling thread alone outside any scope
+thread_pool& threads();
+
+/**
+ * Make a pool the pool of the local search algorithms on the calling thread while it is in scope,
+ * so concurrent solves on different threads each use their own pool
+ */
+class pool_scope {
+	thread_pool* previous;
+
+public:
+	explicit pool_scope(thread_pool& pool);
+
+	~pool_scope();
+
+	pool_scope(const pool_scope&)            = delete;
+	pool_scope& operator=(const pool_scope&) = delete;
+};
+
+#endif    // MKP_THREADS_H
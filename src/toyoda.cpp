@@ -0,0 +1,36 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "toyoda.h"
+
+/**
+ * Build the tree over the keys in O(count)
+ * @param keys
+ * @param count
+ */
+void tournament_tree::build(const double* keys, size_t count) {
+	this->keys = keys;
+
+	leaves = 1;
+	while (leaves < count) leaves *= 2;
+
+	tree.resize(2 * leaves);
+	for (size_t i = 0; i < leaves; ++i) tree[leaves + i] = i < count ? i : none;
+	for (size_t k = leaves - 1; k > 0; --k) tree[k] = winner(tree[2 * k], tree[2 * k + 1]);
+}
+
+/**
+ * Remove the winner and replay its path in O(log count)
+ * @return the index of the winner or npos if the tree is empty
+ */
+size_t tournament_tree::pop() {
+	if (tree.empty() || tree[1] == none) return npos;
+	unsigned int best = tree[1];
+
+	size_t k = leaves + best;
+	tree[k]  = none;
+	for (k /= 2; k > 0; k /= 2) tree[k] = winner(tree[2 * k], tree[2 * k + 1]);
+
+	return best;
+}
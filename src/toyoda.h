@@ -0,0 +1,67 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#ifndef MKP_TOYODA_H
+#define MKP_TOYODA_H
+
+#include "util.h"
+
+#include <cstdint>
+
+/**
+ * Winner tree over a set of keys. The winner is the highest key, ties are broken by the lowest
+ * index, so the order in which the keys are popped is deterministic.
+ */
+class tournament_tree {
+	// Marks a removed or padding leaf
+	static constexpr unsigned int none = UINT_MAX;
+
+	// Number of leaves, a power of two
+	size_t leaves = 0;
+	// Node k holds the index of the winning leaf of its subtree, the leaves start at node leaves
+	Vector<unsigned int> tree;
+	// The keys of the leaves
+	const double* keys = nullptr;
+
+	/**
+	 * Play a match between two leaves
+	 * @param a
+	 * @param b
+	 * @return the winner
+	 */
+	[[nodiscard]] unsigned int winner(unsigned int a, unsigned int b) const {
+		if (a == none) return b;
+		if (b == none) return a;
+		if (keys[a] > keys[b]) return a;
+		if (keys[b] > keys[a]) return b;
+		return std::min(a, b);
+	}
+
+public:
+	static constexpr size_t npos = SIZE_MAX;
+
+	void build(const double* keys, size_t count);
+
+	size_t pop();
+};
+
+/**
+ * Scratch state of a Toyoda completion, kept per thread so a completion does not allocate
+ */
+struct toyoda_state {
+	// The sum of the rescaled constraints of the selected items, padded to the row stride of A
+	Vector<double>       U;
+	// V = A * U of every item, updated with the rows of the inserted items
+	Vector<double>       V;
+	// The unselected items that might still fit
+	Vector<unsigned int> candidates;
+	// The pseudo-utility of each candidate
+	Vector<double>       utility;
+	// The candidates that were tried in the current step
+	Vector<unsigned int> tried;
+	// The selection order of the candidates
+	tournament_tree      tree;
+};
+
+#endif    // MKP_TOYODA_H
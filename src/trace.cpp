@@ -0,0 +1,46 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "trace.h"
+
+#include <limits>
+
+using namespace std::chrono;
+
+trace::trace(std::function<void(const incumbent&)> on_incumbent, unsigned int best_known,
+             size_t capacity):
+	pending(capacity), deliver(std::move(on_incumbent)), best_known(best_known) {
+	// Poll the ring buffer, the producers never have to wake the writer
+	writer = std::jthread([this](std::stop_token stop) {
+		while (!stop.stop_requested()) {
+			drain();
+			std::this_thread::sleep_for(milliseconds(1));
+		}
+	});
+}
+
+void trace::drain() {
+	while (auto update = pending.try_pop()) send(*update);
+}
+
+/**
+ * Deliver a value unless a better one was delivered already, the threads of a parallel solve may
+ * queue their improvements out of order
+ * @param update
+ */
+void trace::send(const progress& update) {
+	if (update.value <= last) return;
+	last = update.value;
+
+	const double gap = best_known > 0 ? 100 * (best_known - update.value) / best_known
+	                                  : std::numeric_limits<double>::quiet_NaN();
+	deliver({ update.elapsed, update.value, update.iterations, update.evaluations, gap });
+}
+
+void trace::finish(const progress& final) {
+	writer.request_stop();
+	writer.join();
+	drain();
+	send(final);
+}
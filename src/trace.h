@@ -0,0 +1,70 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#ifndef MKP_TRACE_H
+#define MKP_TRACE_H
+
+#include "budget.h"
+#include "mpsc_queue.h"
+
+#include <functional>
+#include <thread>
+
+/**
+ * A new best solution of a solve, as the trace delivers it
+ */
+struct incumbent {
+	std::chrono::milliseconds elapsed;
+	unsigned int              value;
+	uint64_t                  iterations;
+	uint64_t                  evaluations;
+	// Percentage gap to the best known value, NaN when it is unknown
+	double gap;
+};
+
+/**
+ * The anytime trace of a solve: the threads of the solve push every new best value into a
+ * lock-free ring buffer and a writer thread of its own drains it into a callback, so a slow
+ * callback never makes the search wait. The writer delivers the values in increasing order; a
+ * burst that fills the ring skips intermediate values, but finish() always delivers the last one.
+ */
+class trace {
+	mpsc_queue<progress>                  pending;
+	std::function<void(const incumbent&)> deliver;
+	double                                best_known;
+	unsigned int                          last = 0;
+	std::jthread                          writer;
+
+	void drain();
+
+	void send(const progress& update);
+
+public:
+	/**
+	 * Start the writer thread
+	 * @param on_incumbent
+	 * @param best_known the value the gaps are relative to, 0 when it is unknown
+	 * @param capacity of the ring buffer
+	 */
+	trace(std::function<void(const incumbent&)> on_incumbent, unsigned int best_known,
+	      size_t capacity = 1 << 14);
+
+	trace(const trace&)            = delete;
+	trace& operator=(const trace&) = delete;
+
+	/**
+	 * Queue a new best value, can be called by any thread
+	 * @param update
+	 */
+	void push(const progress& update) { pending.try_push(update); }
+
+	/**
+	 * Stop the writer thread after delivering everything queued and then the final best value, if
+	 * the writer has not delivered it yet
+	 * @param final
+	 */
+	void finish(const progress& final);
+};
+
+#endif    // MKP_TRACE_H
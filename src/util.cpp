@@ -18,11 +18,10 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
 
+#include "rng.h"
 #include "solution.h"
 #include "util.h"
 
-void set_seed(int seed) { srand(seed); }
-
 int* create_shuffled(int n) {
 	int i, *v = static_cast<int*>(malloc(n * sizeof(int)));
 	for (i = 0; i < n; i++) v[i] = i;
@@ -35,7 +34,7 @@ int* create_shuffled(int n) {
 void shuffle_int(int* v, int n) {
 	int i, j, tmp;
 	for (i = n - 1; i >= 1; i--) {
-		j    = rand() % i;
+		j    = static_cast<int>(generator().below(static_cast<uint64_t>(i) + 1));
 		tmp  = v[i];
 		v[i] = v[j];
 		v[j] = tmp;
@@ -47,31 +46,87 @@ params* read_params(int argc, char* argv[]) {
 
 	// check in mkpdata.h what fields there are
 
-	auto* pars = static_cast<params*>(malloc(sizeof(params)));
+	auto*                   pars          = new params{};
+	bool                    deterministic = true;
+	memetic_sla             ma;
+	simulated_annealing_sla sa;
+	tabu_search_sla         ts;
 
 	pars->instance_file = argv[1];
 	for (i = 2; i < argc; i++) {
 		if (strcmp(argv[i], "--seed") == 0) {
 			pars->seed = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--threads") == 0) {
+			pars->threads = strtoul(argv[++i], nullptr, 10);
+		} else if (strcmp(argv[i], "--population") == 0) {
+			ma.population = strtoul(argv[++i], nullptr, 10);
+		} else if (strcmp(argv[i], "--time") == 0) {
+			pars->limits.time = std::chrono::milliseconds(strtoul(argv[++i], nullptr, 10));
+		} else if (strcmp(argv[i], "--iterations") == 0) {
+			pars->limits.iterations = strtoull(argv[++i], nullptr, 10);
+		} else if (strcmp(argv[i], "--evaluations") == 0) {
+			pars->limits.evaluations = strtoull(argv[++i], nullptr, 10);
+		} else if (strcmp(argv[i], "--target") == 0) {
+			pars->limits.target = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+		} else if (strcmp(argv[i], "--trace") == 0) {
+			pars->trace_file = argv[++i];
+		} else if (strcmp(argv[i], "--best-known") == 0) {
+			pars->best_known = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+		} else if (strcmp(argv[i], "--stats") == 0) {
+			// JSON is the only format
+			pars->stats = strcmp(argv[++i], "json") == 0;
+		} else if (strcmp(argv[i], "--stats-interval") == 0) {
+			pars->stats_interval = std::chrono::milliseconds(strtoul(argv[++i], nullptr, 10));
+		} else if (strcmp(argv[i], "--tempering") == 0) {
+			sa.mode = annealing_mode::tempering;
+		} else if (strcmp(argv[i], "--multistart") == 0) {
+			sa.mode = annealing_mode::multistart;
+		} else if (strcmp(argv[i], "--replicas") == 0) {
+			sa.replicas = strtoul(argv[++i], nullptr, 10);
+		} else if (strcmp(argv[i], "--exchange-interval") == 0) {
+			sa.interval = std::max(strtoul(argv[++i], nullptr, 10), 1ul);
+		} else if (strcmp(argv[i], "--islands") == 0) {
+			ma.islands = strtoul(argv[++i], nullptr, 10);
+		} else if (strcmp(argv[i], "--migration") == 0) {
+			ma.topology = strcmp(argv[++i], "random") == 0 ? migration_topology::random
+			                                               : migration_topology::ring;
+		} else if (strcmp(argv[i], "--migration-interval") == 0) {
+			ma.interval = std::max(strtoul(argv[++i], nullptr, 10), 1ul);
+		} else if (strcmp(argv[i], "--elites") == 0) {
+			ma.elites = strtoul(argv[++i], nullptr, 10);
+		} else if (strcmp(argv[i], "--nondeterministic") == 0) {
+			deterministic = false;
+		} else if (strcmp(argv[i], "--convert") == 0) {
+			pars->convert = true;
 		} else if (strcmp(argv[i], "--verbose") == 0) {
-			verbose = true;
+			pars->verbose = true;
 		} else if (strcmp(argv[i], "--random") == 0) {
-			pars->CH = &Solution::random;
+			pars->CH = random_ch{};
 		} else if (strcmp(argv[i], "--greedy") == 0) {
-			pars->CH = &Solution::greedy;
+			pars->CH = greedy_ch{};
 		} else if (strcmp(argv[i], "--toyoda") == 0) {
-			pars->CH = &Solution::toyoda;
+			pars->CH = toyoda_ch{};
 		} else if (strcmp(argv[i], "--FI") == 0) {
-			pars->II = &Solution::first_improvement;
+			pars->II = first_improvement_ii{};
 		} else if (strcmp(argv[i], "--BI") == 0) {
-			pars->II = &Solution::best_improvement;
+			pars->II = best_improvement_ii{};
 		} else if (strcmp(argv[i], "--VND") == 0) {
-			pars->II = &Solution::variable_neighbourhood_descent;
+			pars->II = vnd_ii{};
 		} else if (strcmp(argv[i], "--SA") == 0) {
-			pars->SLA = &simulated_annealing;
+			pars->SLA = simulated_annealing_sla{};
 		} else if (strcmp(argv[i], "--MA") == 0) {
-			pars->SLA = &memetic_algorithm;
+			pars->SLA = memetic_sla{};
+		} else if (strcmp(argv[i], "--TS") == 0) {
+			pars->SLA = tabu_search_sla{};
+		} else if (strcmp(argv[i], "--tenure") == 0) {
+			ts.tenure = strtoul(argv[++i], nullptr, 10);
 		}
 	}
+
+	if (auto* vnd = std::get_if<vnd_ii>(&pars->II)) vnd->deterministic = deterministic;
+	if (std::holds_alternative<simulated_annealing_sla>(pars->SLA)) pars->SLA = sa;
+	if (std::holds_alternative<memetic_sla>(pars->SLA)) pars->SLA = ma;
+	if (std::holds_alternative<tabu_search_sla>(pars->SLA)) pars->SLA = ts;
+
 	return (pars);
 }
@@ -21,13 +21,24 @@
 #ifndef __MKPUTIL_H__
 #define __MKPUTIL_H__
 
+#include "budget.h"
+#include "telemetry.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <bit>
 #include <cassert>
 #include <climits>
 #include <cmath>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <variant>
 #include <vector>
 
 /**
@@ -65,85 +76,308 @@ public:
 	}
 };
 
+// Row strides are padded to a multiple of this many elements so every row starts 64 byte aligned
+// and can be processed with full SIMD vectors
+constexpr size_t simd_width = 16;
+
+/**
+ * Pad a row length to the SIMD width
+ * @param length
+ * @return
+ */
+constexpr size_t padded(size_t length) {
+	return (length + simd_width - 1) / simd_width * simd_width;
+}
+
 /**
- * Matrix class using the indexing trick for faster computation
+ * Packed bitset of a fixed size, the bits past the size are always zero so whole words can be
+ * compared, hashed and counted
+ */
+class Bitset {
+	size_t                n_bits;
+	std::vector<uint64_t> blocks;
+
+public:
+	Bitset(): n_bits(0) {}
+
+	explicit Bitset(size_t n): n_bits(n), blocks((n + 63) / 64, 0) {}
+
+	[[nodiscard]] size_t size() const { return n_bits; }
+
+	[[nodiscard]] bool test(size_t i) const { return blocks[i / 64] >> (i % 64) & 1; }
+
+	bool operator[](size_t i) const { return test(i); }
+
+	void set(size_t i) { blocks[i / 64] |= uint64_t{ 1 } << (i % 64); }
+
+	void reset(size_t i) { blocks[i / 64] &= ~(uint64_t{ 1 } << (i % 64)); }
+
+	void flip(size_t i) { blocks[i / 64] ^= uint64_t{ 1 } << (i % 64); }
+
+	/**
+	 * @return the number of 64-bit words
+	 */
+	[[nodiscard]] size_t words() const { return blocks.size(); }
+
+	/**
+	 * @param w
+	 * @return the bits [64 * w, 64 * w + 64)
+	 */
+	[[nodiscard]] uint64_t word(size_t w) const { return blocks[w]; }
+
+	/**
+	 * @return the number of set bits
+	 */
+	[[nodiscard]] size_t count() const {
+		size_t total = 0;
+		for (auto block : blocks) total += static_cast<size_t>(std::popcount(block));
+		return total;
+	}
+
+	/**
+	 * @param b a bitset of the same size
+	 * @return the number of bits that differ
+	 */
+	[[nodiscard]] size_t distance(const Bitset& b) const {
+		size_t total = 0;
+		for (size_t w = 0; w < blocks.size(); ++w)
+			total += static_cast<size_t>(std::popcount(blocks[w] ^ b.blocks[w]));
+		return total;
+	}
+
+	/**
+	 * @return a hash of the bits
+	 */
+	[[nodiscard]] size_t hash() const {
+		uint64_t h = n_bits;
+		for (auto block : blocks) {
+			h ^= block + 0x9e3779b97f4a7c15 + (h << 6) + (h >> 2);
+			h *= 0xff51afd7ed558ccd;
+		}
+		return static_cast<size_t>(h ^ (h >> 33));
+	}
+
+	bool operator==(const Bitset& b) const { return n_bits == b.n_bits && blocks == b.blocks; }
+
+	/**
+	 * Call f with the index of every set bit in increasing order
+	 * @tparam F
+	 * @param f
+	 */
+	template<class F> void for_each(F&& f) const {
+		for (size_t w = 0; w < blocks.size(); ++w)
+			for (uint64_t block = blocks[w]; block; block &= block - 1)
+				f(w * 64 + static_cast<size_t>(std::countr_zero(block)));
+	}
+};
+
+/**
+ * Read-only matrix view over 64 byte aligned rows using the indexing trick for faster computation.
+ * The memory is owned elsewhere, e.g. by the image of a problem.
  * @tparam T
  */
 template<class T> class Matrix {
-	size_t    n_tot;
-	size_t    m_tot;
-	Vector<T> items;
+	size_t   n_tot;
+	size_t   m_tot;
+	size_t   stride;
+	const T* items;
 
 public:
 	/**
-	 * Construct the matrix
+	 * Construct the matrix view
+	 * @param items row-major memory of n rows of stride elements
 	 * @param n rows
 	 * @param m columns
+	 * @param stride the padded row length
 	 */
-	Matrix(size_t n, size_t m): n_tot(n), m_tot(m), items(n * m) {}
+	Matrix(const T* items, size_t n, size_t m, size_t stride):
+		n_tot(n), m_tot(m), stride(stride), items(items) {}
 
 	/**
 	 * Index the matrix
 	 * @param n
 	 * @param m
-	 * @return a reference
+	 * @return the value
 	 */
-	T& operator()(size_t n, size_t m) { return items[n * m_tot + m]; }
+	T operator()(size_t n, size_t m) const { return items[n * stride + m]; }
 
 	/**
-	 * Index the matrix
+	 * Access a row, the padding after the last column is zero
 	 * @param n
-	 * @param m
-	 * @return the value
+	 * @return a pointer to the 64 byte aligned row
 	 */
-	T operator()(size_t n, size_t m) const { return items[n * m_tot + m]; }
+	const T* operator[](size_t n) const { return items + n * stride; }
+
+	[[nodiscard]] size_t rows() const { return n_tot; }
+	[[nodiscard]] size_t columns() const { return m_tot; }
 
 	/**
-	 * Matrix vector multiplication M * C
+	 * Matrix vector multiplication M * C.
+	 * Every row is reduced in simd_width independent lanes so the loop vectorizes, for floating
+	 * point types the rounding can therefore differ slightly from a sequential sum.
 	 * @param m matrix
 	 * @param c vector
 	 * @return
 	 */
 	friend Vector<T> operator*(const Matrix<T>& m, const Vector<T>& c) {
 		Vector<T> r(m.n_tot, 0);
+		const T* __restrict vector = c.data();
+
+		for (size_t i = 0; i < m.n_tot; ++i) {
+			const T* __restrict row = std::assume_aligned<64>(m[i]);
 
-		for (size_t i = 0; i < m.n_tot; ++i)
-			for (size_t j = 0; j < m.m_tot; ++j) r[i] += m(i, j) * c[j];
+			T      lanes[simd_width] = {};
+			size_t j                 = 0;
+			for (; j + simd_width <= m.m_tot; j += simd_width)
+				for (size_t l = 0; l < simd_width; ++l) lanes[l] += row[j + l] * vector[j + l];
+
+			T sum = 0;
+			for (; j < m.m_tot; ++j) sum += row[j] * vector[j];
+			for (const auto& lane : lanes) sum += lane;
+			r[i] = sum;
+		}
 
 		return r;
 	}
 
 	/**
-	 * Transposed Matrix vector multiplication M^T * C
+	 * Transposed Matrix vector multiplication M^T * C, each result element sums the rows in order.
+	 * The result is accumulated in one pass over the rows while it fits in the L1 cache, e.g. for
+	 * the n items of repair up to a few thousand items. Wider results are computed in blocks of
+	 * columns that do stay in the L1 cache while all rows stream past. A selection of rows is a
+	 * Bitset, the masked product only visits the selected rows.
 	 * @tparam S
 	 * @param c vector
 	 * @param m matrix
 	 * @return
 	 */
 	template<class S> friend Vector<T> operator*(const Vector<S>& c, const Matrix<T>& m) {
+		static_assert(!std::is_same_v<S, bool>, "select rows with a Bitset");
 		Vector<T> r(m.m_tot, 0);
+		T* __restrict result = r.data();
 
-		for (size_t i = 0; i < m.n_tot; ++i)
-			for (size_t j = 0; j < m.m_tot; ++j) r[j] += m(i, j) * c[i];
+		const auto accumulate = [&](size_t begin, size_t end) {
+			for (size_t i = 0; i < m.n_tot; ++i) {
+				const T           factor = static_cast<T>(c[i]);
+				const T* __restrict row = std::assume_aligned<64>(m[i]);
+				for (size_t j = begin; j < end; ++j) result[j] += row[j] * factor;
+			}
+		};
+
+		if (m.m_tot <= block_columns) accumulate(0, m.m_tot);
+		else
+			for (size_t begin = 0; begin < m.m_tot; begin += block_columns)
+				accumulate(begin, std::min(begin + block_columns, m.m_tot));
 
 		return r;
 	}
+
+	/**
+	 * Masked Matrix vector multiplication S^T * M: the sum of the rows of the set bits only,
+	 * found word by word with a trailing zero count
+	 * @param s the selected rows
+	 * @param m matrix
+	 * @return
+	 */
+	friend Vector<T> operator*(const Bitset& s, const Matrix<T>& m) {
+		Vector<T> r(m.m_tot, 0);
+		m.add_rows(s, r.data());
+		return r;
+	}
+
+	/**
+	 * Add the rows of the set bits to a result of at least m columns, in increasing row order
+	 * @param s the selected rows
+	 * @param result
+	 */
+	void add_rows(const Bitset& s, T* __restrict result) const {
+		s.for_each([&](size_t i) {
+			const T* __restrict row = std::assume_aligned<64>((*this)[i]);
+			for (size_t j = 0; j < m_tot; ++j) result[j] += row[j];
+		});
+	}
+
+private:
+	// Columns per block of the transposed product, 16 KiB of results: one block up to 2048
+	// doubles, mkp-matrix-bench times 26 us unblocked against 15 us blocked for 10^4 items
+	static constexpr size_t block_columns = 16384 / sizeof(T) / simd_width * simd_width;
+};
+
+// Tags selecting the constructive heuristic, the iterative improvement algorithm and the
+// stochastic local search algorithm, they are dispatched statically in engine.h
+struct random_ch {};
+struct greedy_ch {};
+struct toyoda_ch {};
+struct first_improvement_ii {};
+struct best_improvement_ii {};
+struct vnd_ii {
+	// Accept the lexicographically first improvement when running on several threads
+	bool deterministic = true;
+};
+// How the replicas of simulated annealing cooperate: a single chain, parallel tempering on a
+// temperature ladder or independent chains that share the incumbent
+enum class annealing_mode { single, tempering, multistart };
+struct simulated_annealing_sla {
+	annealing_mode mode = annealing_mode::single;
+	// The number of replicas, 0 for one replica per thread
+	size_t replicas = 0;
+	// The steps of a replica between two exchanges or temperature updates
+	size_t interval = 1000;
+};
+// Where the islands of the memetic algorithm send their migrants: the next island or a random one
+enum class migration_topology { ring, random };
+struct memetic_sla {
+	// The number of individuals, of every island
+	size_t population = 100;
+	// The number of islands, 1 for a single population and 0 for one island per thread
+	size_t islands = 1;
+	migration_topology topology = migration_topology::ring;
+	// The generations of an island between two migrations
+	size_t interval = 1000;
+	// The number of best individuals an island sends per migration
+	size_t elites = 2;
+};
+struct tabu_search_sla {
+	// A flipped item stays tabu for a random number of iterations in [tenure, 2 * tenure)
+	size_t tenure = 3;
 };
 
-class Solution;
-struct problem;
+// The options of a solve
+struct options {
+	int    seed{};
+	size_t threads{ 1 };
+	bool   verbose{};
+	// Where the verbose diagnostics of the search go, such as the rates of the replicas, none
+	// for nullptr
+	std::ostream* log{};
+	// The budget of the stochastic local search, the wall time defaults to the instance runtime
+	budget::limits limits;
+	std::variant<std::monostate, random_ch, greedy_ch, toyoda_ch>                      CH;
+	std::variant<std::monostate, first_improvement_ii, best_improvement_ii, vnd_ii>  II;
+	std::variant<std::monostate, simulated_annealing_sla, memetic_sla, tabu_search_sla> SLA;
+	// Called with every new best value, possibly concurrently by the threads of the solve
+	std::function<void(const progress&)> on_progress;
+	// Called with every new best value in increasing order from a writer thread of its own, the
+	// search never waits for it
+	std::function<void(const incumbent&)> on_incumbent;
+	// The value the gaps of on_incumbent are relative to, the best known value of the problem for 0
+	unsigned int best_known{};
+	// Collect the telemetry of the search and return it with the result
+	bool stats{};
+	// Pass the telemetry so far to on_stats every stats_interval while the solve runs, from a
+	// thread of its own, never for 0
+	std::chrono::milliseconds                    stats_interval{};
+	std::function<void(const telemetry_report&)> on_stats;
+};
 
-struct params {
+// The command line parameters
+struct params : options {
 	char* instance_file{};
-	int   seed{};
-	void (Solution::*CH)(const problem&){};
-	void (Solution::*II)(const problem&, void (Solution::*CH)(const problem&)){};
-	Solution (*SLA)(const problem&){};
+	bool  convert{};
+	// Where to write the anytime trace, "-" for stderr
+	char* trace_file{};
 };
 
-// set the random seed
-void set_seed(int seed);
-
 // create a vector of n shuffled integers (values from 0 to n-1)
 int* create_shuffled(int n);
 
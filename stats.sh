@@ -1,35 +1,11 @@
-mkdir Release
-pushd Release || exit
-cmake -DCMAKE_BUILD_TYPE=Release ..
-make
-popd || exit
-printf "\033c"
-pushd mkp_instances/instances || exit
+cmake -S . -B Release -DCMAKE_BUILD_TYPE=Release || exit
+cmake --build Release --target mkp-bench || exit
 
-FILENAME="../../data/MA_new.data"
-rm $FILENAME
+mkdir -p data/bench
 
-for file in *; do
-  echo "$file"
-  printf "$file " >>$FILENAME
-  ../../Release/MKP "$file" --MA >>$FILENAME
-  printf "\n" >>$FILENAME
-done
+# The solution quality of the memetic algorithm on every instance
+Release/mkp-bench --algorithms "--MA" --fractions 1 --csv data/bench/MA || exit
 
-#FILENAME="../../data/rtd/MA_1.data"
-#rm $FILENAME
-#
-#for f in {1..5}; do
-#  file="OR10x250-0.25_$f.dat"
-#  printf "$file " >>$FILENAME
-#done
-#printf "\n" >>$FILENAME
-#for i in {1..25}; do
-#  echo "$i"
-#  for f in {1..5}; do
-#      file="OR10x250-0.25_$f.dat"
-#    ../../Release/MKP "$file" --MA --seed "$i" >>$FILENAME
-#    printf " " >>$FILENAME
-#  done
-#  printf "\n" >>$FILENAME
-#done
+# The run-time distributions over 25 seeds on the instances of size 250 with tightness 0.25
+Release/mkp-bench --algorithms "--MA;--SA" --fractions 1,0.1,0.01 --seeds 25 \
+  --filter OR10x250-0.25_ --csv data/bench/rtd --json data/bench/rtd.json
@@ -0,0 +1,116 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "budget.h"
+#include "check.h"
+#include "instances.h"
+#include "solver.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+using namespace std::chrono;
+
+/**
+ * Solve with simulated annealing, which otherwise runs for the runtime of the instance, under a
+ * limit that must stop it within seconds
+ * @param p
+ * @param limits
+ * @param what the limit
+ * @return the result
+ */
+static result limited(const problem& p, const budget::limits& limits, const std::string& what) {
+	options o;
+	o.SLA    = simulated_annealing_sla{};
+	o.limits = limits;
+
+	const auto begin = steady_clock::now();
+	auto       r     = solve(p, o);
+	check(r.has_value(), what + ": the solve is rejected");
+	check(steady_clock::now() - begin < seconds(10), what + ": the limit does not stop the solve");
+	return r.value_or(result{});
+}
+
+int main() {
+	// The instance runs for 50 s without a limit
+	const problem* p = random_instance(100, 5).build();
+
+	// Every limit of a budget on its own
+	budget::limits limits;
+	limits.iterations = 10;
+	budget iterations(limits);
+	for (int k = 0; k < 10; ++k) check(iterations.spend(1, 0), "an iteration within the limit");
+	check(!iterations.spend(1, 0) && iterations.exhausted(), "the iteration limit does not stop");
+
+	limits             = {};
+	limits.evaluations = 10;
+	budget evaluations(limits);
+	check(evaluations.spend(0, 10), "evaluations within the limit");
+	check(!evaluations.spend(0, 1), "the evaluation limit does not stop");
+
+	limits        = {};
+	limits.target = 100;
+	budget target(limits);
+	target.report(99);
+	check(target.spend(1, 1) && target.best() == 99, "a value below the target stops");
+	target.report(100);
+	check(!target.spend(1, 1) && target.best() == 100, "the target does not stop");
+
+	limits      = {};
+	limits.time = milliseconds(20);
+	budget time(limits);
+	while (time.spend(1, 1)) {}
+	check(time.elapsed() >= milliseconds(20), "the time limit stops early");
+
+	// A cancel flag shared by two budgets stops both
+	std::atomic<bool> cancelled = false;
+	limits                      = {};
+	limits.cancel               = &cancelled;
+	budget first(limits), second(limits);
+	check(first.spend(1, 1) && second.spend(1, 1), "a budget stops before it is cancelled");
+	cancelled = true;
+	check(!first.spend(1, 1) && !second.spend(1, 1), "the cancel flag does not stop both budgets");
+
+	// Every limit stops a solve
+	limits      = {};
+	limits.time = milliseconds(100);
+	auto r      = limited(*p, limits, "time");
+	check(r.stats.elapsed >= milliseconds(100), "the time limit stops the solve early");
+
+	limits            = {};
+	limits.iterations = 5000;
+	r                 = limited(*p, limits, "iterations");
+	check(r.stats.iterations >= 5000 && r.stats.iterations <= 5001,
+	      "the solve spends " + std::to_string(r.stats.iterations) + " of 5000 iterations");
+
+	limits             = {};
+	limits.evaluations = 5000;
+	r                  = limited(*p, limits, "evaluations");
+	check(r.stats.evaluations >= 5000 && r.stats.evaluations <= 5001,
+	      "the solve spends " + std::to_string(r.stats.evaluations) + " of 5000 evaluations");
+
+	limits        = {};
+	limits.target = 1;
+	r             = limited(*p, limits, "target");
+	check(r.best.value >= 1, "the target stops the solve before it is reached");
+
+	// A flag cancels two solves running at the same time
+	cancelled     = false;
+	limits        = {};
+	limits.cancel = &cancelled;
+	result      parallel;
+	std::thread other([&] { parallel = limited(*p, limits, "cancel"); });
+	std::thread canceller([&] {
+		std::this_thread::sleep_for(milliseconds(100));
+		cancelled = true;
+	});
+	r = limited(*p, limits, "cancel");
+	other.join();
+	canceller.join();
+	check(r.best.value > 0 && parallel.best.value > 0, "a cancelled solve has no solution");
+
+	delete p;
+	return exit_status();
+}
@@ -0,0 +1,37 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#ifndef MKP_TESTS_CHECK_H
+#define MKP_TESTS_CHECK_H
+
+#include <iostream>
+#include <source_location>
+#include <string>
+
+// The number of failed checks of the test
+inline int failures = 0;
+
+/**
+ * Check a condition, a failure is reported with its location and fails the test at the end
+ * @param condition
+ * @param what a description of the failure
+ * @param where
+ */
+inline void check(bool condition, const std::string& what,
+                  std::source_location where = std::source_location::current()) {
+	if (condition) return;
+	++failures;
+	std::cerr << where.file_name() << ":" << where.line() << ": " << what << "\n";
+}
+
+/**
+ * The exit status of the test
+ * @return
+ */
+inline int exit_status() {
+	if (failures) std::cerr << failures << " checks failed\n";
+	return failures ? 1 : 0;
+}
+
+#endif    // MKP_TESTS_CHECK_H
@@ -0,0 +1,115 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "check.h"
+#include "engine.h"
+#include "instances.h"
+#include "mkpproblem.h"
+#include "reference.h"
+#include "rng.h"
+#include "solution.h"
+
+#include <cmath>
+#include <string>
+
+/**
+ * Chi-square statistic of the counts of the offspring that copied each differing item from b,
+ * against the expected half of the offspring, normalized to a z-score
+ */
+static double uniformity(const Vector<size_t>& from_b, size_t offspring) {
+	const double expected = static_cast<double>(offspring) / 2;
+	double       chi2     = 0;
+	for (auto count : from_b) chi2 += std::pow(static_cast<double>(count) - expected, 2) / expected;
+	// A binomial count with p = 1/2 has a variance of half its expectation, so every term divided
+	// by 1/2 is chi-square with one degree of freedom
+	const auto d = static_cast<double>(from_b.size());
+	return (chi2 / 0.5 - d) / std::sqrt(2 * d);
+}
+
+/**
+ * Compare the offspring distribution of the bit-parallel crossover with the per-item reference:
+ * every differing item must be copied from b in half of the offspring, pairs of neighbouring
+ * differing items must be independent and the two distributions must agree. Every statistic is
+ * a z-score that fails beyond 4, which a correct crossover does about once in 10^4 runs.
+ * @param p
+ * @param a
+ * @param b
+ * @param offspring
+ */
+template<size_t W>
+static void distribution(const problem& p, const Solution<W>& a, const Solution<W>& b,
+                         size_t offspring) {
+	Vector<size_t> differing;
+	for (size_t item = 0; item < a.items().size(); ++item)
+		if (a.items()[item] != b.items()[item]) differing.push_back(item);
+	const size_t d = differing.size();
+
+	// Count how often every differing item, and every neighbouring pair, is copied from b
+	// The reference draws from a different seed, the two samples must be independent
+	Vector<size_t> from_b(d, 0), pairs(d, 0), reference_from_b(d, 0);
+	rng            random(8);
+	generator() = rng(7);
+	for (size_t k = 0; k < offspring; ++k) {
+		auto child = crossover(a, b, p);
+		auto from  = [&](size_t i) {
+			return child.items()[differing[i]] == b.items()[differing[i]];
+		};
+		for (size_t i = 0; i < d; ++i) {
+			const bool copied = from(i);
+			from_b[i] += copied;
+			pairs[i] += copied && i + 1 < d && from(i + 1);
+		}
+
+		reference_child reference(a.items(), p);
+		reference.cross(a.items(), b.items(), p, random);
+		for (size_t i = 0; i < d; ++i)
+			reference_from_b[i] += reference.sol[differing[i]] == b.items()[differing[i]];
+	}
+
+	// Independence of neighbouring items: both are copied from b in a quarter of the offspring
+	const double expected = static_cast<double>(offspring) / 4;
+	double       chi2     = 0;
+	for (size_t i = 0; i + 1 < d; ++i)
+		chi2 += std::pow(static_cast<double>(pairs[i]) - expected, 2) / expected;
+	const double pair_z = (chi2 / 0.75 - static_cast<double>(d - 1)) /
+	                      std::sqrt(2 * static_cast<double>(d - 1));
+
+	// Two-sample test between the bit-parallel and the reference counts: the difference of two
+	// independent counts has a variance of half the offspring
+	double two_sample = 0;
+	for (size_t i = 0; i < d; ++i) {
+		const auto diff = static_cast<double>(from_b[i]) - static_cast<double>(reference_from_b[i]);
+		two_sample += diff * diff / (static_cast<double>(offspring) / 2);
+	}
+	const double two_sample_z = (two_sample - static_cast<double>(d)) /
+	                            std::sqrt(2 * static_cast<double>(d));
+
+	const double bit_z       = uniformity(from_b, offspring);
+	const double reference_z = uniformity(reference_from_b, offspring);
+	const auto   n           = std::to_string(p.n) + ": ";
+	check(std::abs(bit_z) < 4, n + "items are not copied from b with probability 1/2, z = " +
+	                               std::to_string(bit_z));
+	check(std::abs(reference_z) < 4, n + "the reference is not uniform, z = " +
+	                                     std::to_string(reference_z));
+	check(std::abs(pair_z) < 4, n + "neighbouring items are not independent, z = " +
+	                                std::to_string(pair_z));
+	check(std::abs(two_sample_z) < 4, n + "the bit-parallel and the reference offspring differ, "
+	                                      "z = " + std::to_string(two_sample_z));
+}
+
+int main() {
+	for (size_t n : { 100, 250, 10000 }) {
+		const problem* p = random_instance(n, 10).build();
+		with_width(*p, [&](auto width) {
+			constexpr size_t W = decltype(width)::value;
+			generator() = rng(1);
+			const Solution<W> a(*p, random_ch{});
+			const Solution<W> b(*p, random_ch{});
+			distribution(*p, a, b, n > 1000 ? 2000 : 20000);
+		});
+		delete p;
+	}
+
+	return exit_status();
+}
@@ -0,0 +1,50 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "check.h"
+#include "engine.h"
+#include "instances.h"
+#include "mkpproblem.h"
+#include "reference.h"
+#include "rng.h"
+#include "solution.h"
+
+#include <string>
+
+/**
+ * Run every iterative improvement algorithm with the static tag dispatch of the constructive
+ * heuristics and with the member function pointers it replaced, the solutions must be equal
+ * @param p
+ * @param name
+ */
+template<size_t W> static void engine(const problem& p, const std::string& name) {
+	const auto run = [&](auto ch, auto ii, int seed) {
+		generator() = rng(seed);
+		Solution<W> s(p, ch);
+		improve(s, p, ch, ii);
+		return s;
+	};
+	const auto compare = [&](const char* algorithm, auto ii) {
+		for (int seed = 0; seed < 2; ++seed) {
+			check(run(opaque(&Solution<W>::greedy), ii, seed) == run(greedy_ch{}, ii, seed),
+			      name + ": greedy + " + algorithm + " differs from the member pointer dispatch");
+			check(run(opaque(&Solution<W>::toyoda), ii, seed) == run(toyoda_ch{}, ii, seed),
+			      name + ": toyoda + " + algorithm + " differs from the member pointer dispatch");
+		}
+	};
+	compare("FI", first_improvement_ii{});
+	compare("BI", best_improvement_ii{});
+	compare("VND", vnd_ii{});
+}
+
+int main() {
+	for (auto [n, m] : { std::pair{ 100, 5 }, { 100, 30 }, { 50, 40 } }) {
+		const problem* p    = random_instance(n, m).build();
+		const auto     name = "random " + std::to_string(n) + "x" + std::to_string(m);
+		with_width(*p, [&](auto width) { engine<decltype(width)::value>(*p, name); });
+		delete p;
+	}
+
+	return exit_status();
+}
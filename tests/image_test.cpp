@@ -0,0 +1,85 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "check.h"
+#include "instances.h"
+#include "mkpio.h"
+#include "mkpproblem.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// Every file of the test goes here
+static const auto directory = std::filesystem::temp_directory_path() / "mkp-image-test";
+
+/**
+ * Write a file into the directory of the test
+ * @param name
+ * @param text
+ * @return the path of the file
+ */
+static std::string file(const std::string& name, const std::string& text) {
+	auto          path = (directory / name).string();
+	std::ofstream out(path, std::ios::binary);
+	out << text;
+	return path;
+}
+
+int main() {
+	std::filesystem::create_directories(directory);
+
+	// A binary image survives a round trip
+	std::string     error;
+	random_instance instance(50, 5);
+	auto            dat = (directory / "random.dat").string();
+	instance.write(dat);
+	auto image = parse_instance(dat.c_str(), error);
+	check(image != nullptr, "the random instance is rejected: " + error);
+	if (image) {
+		auto mkpb = (directory / "random.mkpb").string();
+		check(write_image(*image, mkpb.c_str(), error), "the image cannot be written: " + error);
+		auto mapped = map_image(mkpb.c_str(), error);
+		check(mapped && mapped->size == image->size &&
+		          std::equal(image->section<int>(image->profits),
+		                     image->section<int>(image->profits) + image->n,
+		                     mapped->section<int>(mapped->profits)),
+		      "the mapped image differs from the written one");
+
+		// A sidecar newer than its instance is read instead of it, the instance has no best known
+		// value and the sidecar has one
+		auto sidecar = (directory / "sidecar.mkpb").string();
+		auto source  = (directory / "sidecar.dat").string();
+		instance.write(source);
+		image->best_known = 99;
+		check(write_image(*image, sidecar.c_str(), error),
+		      "the sidecar cannot be written: " + error);
+		std::filesystem::last_write_time(
+			sidecar, std::filesystem::last_write_time(source) + std::chrono::minutes(1));
+		const problem* p = read_problem(source.c_str(), &error);
+		check(p && p->best_known == 99, "a fresh sidecar is not read: " + error);
+		delete p;
+	}
+
+	// An invalid image is rejected
+	auto garbage = file("garbage.mkpb", std::string(256, 'x'));
+	error.clear();
+	check(!map_image(garbage.c_str(), error), "mapped an invalid image");
+	check(error.find("invalid or incompatible binary image") != std::string::npos,
+	      "an invalid image is reported as \"" + error + "\"");
+	check(!read_problem(garbage.c_str(), &error), "read an invalid image");
+
+	// An invalid sidecar newer than its instance is ignored
+	auto sidecar = file("random.mkpb", "garbage");
+	auto newer   = std::filesystem::last_write_time(dat) + std::chrono::minutes(1);
+	std::filesystem::last_write_time(sidecar, newer);
+	const problem* p = read_problem(dat.c_str(), &error);
+	check(p && p->n == 50 && p->m == 5, "an invalid sidecar is not ignored: " + error);
+	delete p;
+
+	std::filesystem::remove_all(directory);
+	return exit_status();
+}
@@ -0,0 +1,140 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "check.h"
+#include "engine.h"
+#include "instances.h"
+#include "mkpproblem.h"
+#include "rng.h"
+#include "solution.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+/**
+ * The private state of Solution the test compares
+ */
+struct kernel_access {
+	template<size_t W> static bool add(Solution<W>& s, size_t item, const problem& p) {
+		return s.add(item, p);
+	}
+
+	template<size_t W> static bool remove(Solution<W>& s, size_t item, const problem& p) {
+		return s.remove(item, p);
+	}
+
+	template<size_t W> static void commit(Solution<W>& s) { s.commit(); }
+
+	template<size_t W> static size_t checkpoint(const Solution<W>& s) { return s.checkpoint(); }
+
+	template<size_t W> static void rollback(Solution<W>& s, const problem& p, size_t checkpoint) {
+		s.rollback(p, checkpoint);
+	}
+
+	// Roll back all changes since the last commit and replay them
+	template<size_t W> static void rollback_replay(Solution<W>& s, const problem& p) {
+		auto moves = s.journal;
+		s.rollback(p);
+		s.replay(p, moves);
+	}
+
+	template<size_t W> static size_t journaled(const Solution<W>& s) { return s.journal.size(); }
+
+	/**
+	 * Everything an add or remove changes: the value, the items, the hash, the used resources
+	 * and the selected items in sorted order
+	 */
+	struct state {
+		unsigned int              value;
+		Bitset                    items;
+		uint64_t                  hash;
+		std::vector<int>          resources;
+		std::vector<unsigned int> selected;
+
+		bool operator==(const state&) const = default;
+	};
+
+	template<size_t W> static state of(const Solution<W>& s) {
+		std::vector<unsigned int> selected(s.selected.begin(), s.selected.end());
+		std::sort(selected.begin(), selected.end());
+		return { s.value, s.sol, s.zobrist,
+			     { s.resources_used.begin(), s.resources_used.end() }, selected };
+	}
+};
+
+/**
+ * The state a solution must have: everything recomputed from its items
+ */
+template<size_t W> static kernel_access::state expected(const Solution<W>& s, const problem& p) {
+	auto e     = kernel_access::of(s);
+	e.value    = 0;
+	e.hash     = 0;
+	e.selected = {};
+	std::fill(e.resources.begin(), e.resources.end(), 0);
+	s.items().for_each([&](size_t item) {
+		e.value += p.profits[item];
+		e.hash ^= p.zobrist[item];
+		e.selected.push_back(static_cast<unsigned int>(item));
+		for (size_t i = 0; i < e.resources.size(); ++i) e.resources[i] += p.constraints[item][i];
+	});
+	return e;
+}
+
+/**
+ * Apply random adds and removes to random solutions and check that rolling back to a checkpoint
+ * and to the last commit restores the solution exactly, and that replaying the journal redoes the
+ * moves
+ * @param p
+ * @param name
+ */
+template<size_t W> static void journal(const problem& p, const std::string& name) {
+	for (int run = 0; run < 20; ++run) {
+		generator() = rng(run);
+		Solution<W> s(p, random_ch{});
+		kernel_access::commit(s);
+		const auto committed = kernel_access::of(s);
+		check(committed == expected(s, p), name + ": a random solution is inconsistent");
+
+		// Random moves, a checkpoint halfway. An item that is not selected and does not fit is not
+		// moved.
+		size_t     moved_items = 0;
+		const auto moves       = [&](size_t count) {
+			for (size_t k = 0; k < count; ++k) {
+				const auto item = generator().below(static_cast<uint32_t>(p.n));
+				moved_items += kernel_access::add(s, item, p) || kernel_access::remove(s, item, p);
+			}
+		};
+		moves(20);
+		const auto checkpoint = kernel_access::checkpoint(s);
+		const auto halfway    = kernel_access::of(s);
+		moves(20);
+		const auto moved = kernel_access::of(s);
+		check(moved == expected(s, p), name + ": the moves leave an inconsistent solution");
+		check(!s.invalid(p), name + ": the moves leave an infeasible solution");
+
+		kernel_access::rollback_replay(s, p);
+		check(kernel_access::of(s) == moved,
+		      name + ": replaying the journal differs from the moves");
+		check(kernel_access::journaled(s) == moved_items, name + ": the replay is not journaled");
+
+		kernel_access::rollback(s, p, checkpoint);
+		check(kernel_access::of(s) == halfway, name + ": rolling back to a checkpoint differs");
+		kernel_access::rollback(s, p, 0);
+		check(kernel_access::of(s) == committed, name + ": rolling back to the commit differs");
+		check(kernel_access::journaled(s) == 0,
+		      name + ": the rollback leaves moves in the journal");
+	}
+}
+
+int main() {
+	for (auto [n, m] : { std::pair{ 100, 5 }, { 250, 30 }, { 100, 40 } }) {
+		const problem* p    = random_instance(n, m).build();
+		const auto     name = "random " + std::to_string(n) + "x" + std::to_string(m);
+		with_width(*p, [&](auto width) { journal<decltype(width)::value>(*p, name); });
+		delete p;
+	}
+
+	return exit_status();
+}
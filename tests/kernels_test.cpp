@@ -0,0 +1,82 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "check.h"
+#include "instances.h"
+#include "kernels.h"
+#include "reference.h"
+
+#include <functional>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Add and remove a random stream of items against nearly full knapsacks with every supported
+ * instruction set, the feasibility and the used resources must match the original loops
+ * @param m
+ */
+static void kernels(size_t m) {
+	const size_t    items = 256, stride = padded(m);
+	random_instance instance(items, m);
+
+	std::vector<int> weights(items * stride, 0), capacities(stride, 0);
+	for (size_t j = 0; j < items; ++j)
+		for (size_t i = 0; i < m; ++i) weights[j * stride + i] = instance.weights[i][j];
+	for (size_t i = 0; i < m; ++i) capacities[i] = instance.capacities[i] / 20;
+
+	// Every kernel under test, with its name, called with the padded length
+	struct kernel {
+		std::string                                       name;
+		std::function<bool(int*, const int*, const int*)> add;
+		std::function<void(int*, const int*)>             remove;
+	};
+	std::vector<kernel> tested;
+	for (const auto* k : { &scalar_kernels, &avx2_kernels, &avx512_kernels })
+		if (k->supported())
+			tested.push_back({ k->name,
+			                   [k, stride](int* u, const int* x, const int* c) {
+				                   return k->add(u, x, c, stride);
+			                   },
+			                   [k, stride](int* u, const int* x) { k->remove(u, x, stride); } });
+	const auto fixed = [&](auto length) {
+		constexpr size_t L = decltype(length)::value;
+		for (const auto* k : { &fixed_kernels<L>::scalar, &fixed_kernels<L>::avx2,
+		                       &fixed_kernels<L>::avx512 })
+			if (k->supported())
+				tested.push_back({ std::string("fixed ") + k->name, k->add, k->remove });
+	};
+	if (stride == 16) fixed(std::integral_constant<size_t, 16>{});
+	else if (stride == 32)
+		fixed(std::integral_constant<size_t, 32>{});
+
+	for (const auto& k : tested) {
+		std::vector<int>                            reference(stride, 0), used(stride, 0);
+		std::uniform_int_distribution<unsigned int> item(0, items - 1);
+		std::mt19937                                gen(1);
+		for (size_t step = 0; step < 20000; ++step) {
+			const int* x     = weights.data() + item(gen) * stride;
+			const bool added = add_reference(reference.data(), x, capacities.data(), m);
+			check(k.add(used.data(), x, capacities.data()) == added,
+			      "m = " + std::to_string(m) + ": " + k.name + " add differs from the reference");
+			// Remove again with probability 1/2, so the knapsacks fill up and stay nearly full
+			if (added && (gen() & 1)) {
+				remove_reference(reference.data(), x, m);
+				k.remove(used.data(), x);
+			}
+			if (used != reference) {
+				check(false, "m = " + std::to_string(m) + ": " + k.name +
+				                 " resources differ from the reference");
+				break;
+			}
+		}
+	}
+}
+
+int main() {
+	for (size_t m : { 1, 5, 10, 16, 30, 40, 100 }) kernels(m);
+
+	return exit_status();
+}
@@ -0,0 +1,55 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "check.h"
+#include "instances.h"
+#include "solver.h"
+
+#include <string>
+
+/**
+ * Check whether a solve runs with the options
+ * @param p
+ * @param o
+ * @param runs whether the options are valid
+ * @param what a description of the options
+ */
+static void solves(const problem& p, const options& o, bool runs, const std::string& what) {
+	check(valid_options(o) == runs, what + (runs ? " are rejected" : " are accepted"));
+	check(solve(p, o).has_value() == runs, what + (runs ? " do not solve" : " solve"));
+}
+
+int main() {
+	const problem* p = random_instance(50, 5).build();
+
+	options o;
+	o.limits.iterations = 100;
+	solves(*p, o, false, "options without an algorithm");
+
+	o.CH = greedy_ch{};
+	solves(*p, o, true, "greedy options");
+
+	o.CH = std::monostate{};
+	memetic_sla ma;
+	o.SLA = ma;
+	solves(*p, o, true, "the default memetic options");
+	ma.population = 0;
+	o.SLA         = ma;
+	solves(*p, o, false, "an empty population");
+	ma            = {};
+	ma.interval   = 0;
+	o.SLA         = ma;
+	solves(*p, o, false, "a migration interval of 0");
+
+	simulated_annealing_sla sa;
+	sa.mode = annealing_mode::tempering;
+	o.SLA   = sa;
+	solves(*p, o, true, "the parallel tempering options");
+	sa.interval = 0;
+	o.SLA       = sa;
+	solves(*p, o, false, "an exchange interval of 0");
+
+	delete p;
+	return exit_status();
+}
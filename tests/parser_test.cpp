@@ -0,0 +1,107 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "check.h"
+#include "mkpio.h"
+#include "mkpproblem.h"
+
+#include <climits>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// Every file of the test goes here
+static const auto directory = std::filesystem::temp_directory_path() / "mkp-parser-test";
+
+/**
+ * Write a file into the directory of the test
+ * @param name
+ * @param text
+ * @return the path of the file
+ */
+static std::string file(const std::string& name, const std::string& text) {
+	auto          path = (directory / name).string();
+	std::ofstream out(path, std::ios::binary);
+	out << text;
+	return path;
+}
+
+/**
+ * Parse an instance that must be rejected and check the reason
+ * @param text the instance
+ * @param reason the part of the error that must be reported
+ */
+static void rejected(const std::string& text, const std::string& reason) {
+	std::string error;
+	auto        path  = file("rejected.dat", text);
+	auto        image = parse_instance(path.c_str(), error);
+	check(!image, "accepted \"" + text + "\"");
+	check(error.find(reason) != std::string::npos,
+	      "\"" + text + "\" is rejected with \"" + error + "\" instead of \"" + reason + "\"");
+}
+
+/**
+ * Parse an instance that must be accepted
+ * @param text the instance
+ * @return the image
+ */
+static std::shared_ptr<mkpb_header> accepted(const std::string& text) {
+	std::string error;
+	auto        path  = file("accepted.dat", text);
+	auto        image = parse_instance(path.c_str(), error);
+	check(image != nullptr, "rejected \"" + text + "\": " + error);
+	return image;
+}
+
+int main() {
+	std::filesystem::create_directories(directory);
+
+	// A valid instance: 2 items, 1 knapsack
+	auto image = accepted("2 1 7\n3 4\n5 6\n10\n");
+	if (image) {
+		check(image->n == 2 && image->m == 1 && image->best_known == 7, "the header is wrong");
+		check(image->section<int>(image->profits)[1] == 4, "the profits are wrong");
+		check(image->section<int>(image->constraints)[image->stride] == 6,
+		      "the constraints are wrong");
+		check(image->section<int>(image->capacities)[0] == 10, "the capacities are wrong");
+	}
+
+	// The extremes of int, the magnitude of INT_MIN is one more than INT_MAX
+	image = accepted("1 1 " + std::to_string(INT_MIN) + "\n1\n1\n1\n");
+	check(image && image->best_known == INT_MIN, "INT_MIN is read wrong");
+	image = accepted("1 1 " + std::to_string(INT_MAX) + "\n1\n1\n1\n");
+	check(image && image->best_known == INT_MAX, "INT_MAX is read wrong");
+	accepted("1\t1\r\n0 1 1 1");
+
+	rejected("", "empty or unreadable file");
+	rejected("2 1 0\n3 4\n5 6\n  ", "unexpected end of file while reading the capacities");
+	rejected("2 1 0\n3 4x\n5 6\n10\n", "2:4: malformed integer while reading the profits");
+	rejected("2 1 0\n3 -\n5 6\n10\n", "expected an integer while reading the profits");
+	rejected("1 1 2147483648\n1\n1\n1\n", "integer out of range while reading the best known");
+	rejected("1 1 -2147483649\n1\n1\n1\n", "integer out of range while reading the best known");
+	rejected("0 1 0\n\n\n1\n", "invalid problem size 0 x 1");
+	rejected("2 -1 0\n3 4\n", "invalid problem size 2 x -1");
+	rejected("2 2 0\n3 4\n5 6\n7 8\n10 0\n", "invalid capacity 0 of knapsack 2");
+	rejected("2 1 0\n3 4\n5 6\n-10\n", "invalid capacity -10 of knapsack 1");
+
+	// A truncated instance is rejected at its end
+	rejected("3 2 0\n1 2 3\n4 5" + std::string(12, ' '),
+	         "3:16: unexpected end of file while reading the constraints");
+
+	// A size that cannot fit in the file is rejected before anything is allocated, whether its
+	// image would wrap around 64 bits or just be huge
+	rejected("1073741824 2147483647 0\n1 2 3\n",
+	         "too small for a problem of 1073741824 x 2147483647");
+	rejected("100000 100000 0\n1 2 3\n", "too small for a problem of 100000 x 100000");
+	rejected("2 1 0\n3 4\n5 6\n", "too small for a problem of 2 x 1");
+
+	std::string error;
+	check(!parse_instance((directory / "missing.dat").c_str(), error), "parsed a missing file");
+	check(error.find("error opening input file") != std::string::npos,
+	      "a missing file is reported as \"" + error + "\"");
+	check(!read_problem((directory / "missing.dat").c_str(), &error), "read a missing file");
+
+	std::filesystem::remove_all(directory);
+	return exit_status();
+}
@@ -0,0 +1,127 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "check.h"
+#include "engine.h"
+#include "instances.h"
+#include "mkpproblem.h"
+#include "population.h"
+#include "rng.h"
+#include "solution.h"
+
+#include <string>
+
+/**
+ * The private state of Population and Solution the test checks
+ */
+struct kernel_access {
+	/**
+	 * Check the min-heap, the positions of the individuals in it and the hash index against the
+	 * individuals
+	 * @return whether the population is consistent
+	 */
+	template<size_t W> static bool consistent(const Population<W>& population) {
+		const auto& heap = population.heap;
+		const auto& slot = population.slot;
+		const auto  size = population.individuals.size();
+		if (heap.size() != size || slot.size() != size || population.index.size() != size)
+			return false;
+
+		for (size_t i = 0; i < size; ++i) {
+			if (slot[heap[i]] != i) return false;
+			if (i > 0 && population.worse(heap[i], heap[(i - 1) / 2])) return false;
+
+			// Every individual is indexed once, under its own hash
+			size_t indexed    = 0;
+			auto [begin, end] = population.index.equal_range(population.individuals[i].hash());
+			for (auto it = begin; it != end; ++it) indexed += it->second == i;
+			if (indexed != 1) return false;
+		}
+		return true;
+	}
+
+	// Give a solution the hash of another one, without changing its items
+	template<size_t W> static void collide(Solution<W>& s, const Solution<W>& other) {
+		s.zobrist = other.zobrist;
+	}
+};
+
+/**
+ * @param population
+ * @return the index of the individual with the lowest value, the first one on ties
+ */
+template<size_t W> static size_t lowest(const Population<W>& population) {
+	size_t worst = 0;
+	for (size_t i = 1; i < population.size(); ++i)
+		if (population[i] < population[worst]) worst = i;
+	return worst;
+}
+
+/**
+ * @param population
+ * @param s
+ * @return whether an individual equal to s is in the population, by comparing all of them
+ */
+template<size_t W> static bool scan(const Population<W>& population, const Solution<W>& s) {
+	for (size_t i = 0; i < population.size(); ++i)
+		if (population[i] == s) return true;
+	return false;
+}
+
+/**
+ * Run the replacement of the memetic algorithm on a population and check it after every step
+ * @param p
+ * @param name
+ */
+template<size_t W> static void replacement(const problem& p, const std::string& name) {
+	generator() = rng(3);
+	Population<W> population;
+	for (int i = 0; i < 30; ++i) population.push(Solution<W>(p, random_ch{}));
+	check(kernel_access::consistent(population), name + ": the initial population is inconsistent");
+
+	for (int step = 0; step < 2000; ++step) {
+		// Children are offspring of two individuals, which are often equal to one of them
+		const auto& a     = population[generator().below(population.size())];
+		const auto& b     = population[generator().below(population.size())];
+		auto        child = Solution<W>::offspring(a, b, p);
+
+		const bool duplicate = population.contains(child);
+		if (duplicate != scan(population, child)) {
+			check(false, name + ": contains disagrees with a full comparison");
+			return;
+		}
+		if (duplicate) continue;
+
+		// The worst individual is replaced and no other
+		const size_t worst = lowest(population);
+		if (&population.worst() != &population[worst]) {
+			check(false, name + ": the worst individual is not the lowest value");
+			return;
+		}
+		const auto value = child.profit();
+		population.replace_worst(std::move(child));
+		if (population[worst].profit() != value || !kernel_access::consistent(population)) {
+			check(false, name + ": replacing the worst individual breaks the population");
+			return;
+		}
+	}
+
+	// An individual is a duplicate of itself, and an equal hash alone is not a duplicate
+	check(population.contains(population[7]), name + ": an individual is not a duplicate");
+	Solution<W> other(p, random_ch{});
+	while (scan(population, other)) other = Solution<W>(p, random_ch{});
+	kernel_access::collide(other, population[7]);
+	check(!population.contains(other), name + ": a hash collision is a duplicate");
+}
+
+int main() {
+	for (auto [n, m] : { std::pair{ 60, 5 }, { 60, 30 }, { 60, 40 } }) {
+		const problem* p    = random_instance(n, m).build();
+		const auto     name = "random " + std::to_string(n) + "x" + std::to_string(m);
+		with_width(*p, [&](auto width) { replacement<decltype(width)::value>(*p, name); });
+		delete p;
+	}
+
+	return exit_status();
+}
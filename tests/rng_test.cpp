@@ -0,0 +1,89 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "check.h"
+#include "rng.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+/**
+ * Chi-square statistic of bucket counts against a uniform distribution, normalized to a z-score.
+ * A correct generator fails beyond 4 about once in 10^4 runs, and every seed of the test is fixed.
+ * @param counts
+ * @param draws
+ * @return
+ */
+static double uniformity(const std::vector<size_t>& counts, size_t draws) {
+	const double expected = static_cast<double>(draws) / static_cast<double>(counts.size());
+	double       chi2     = 0;
+	for (auto count : counts) chi2 += std::pow(static_cast<double>(count) - expected, 2) / expected;
+	const auto dof = static_cast<double>(counts.size() - 1);
+	return (chi2 - dof) / std::sqrt(2 * dof);
+}
+
+/**
+ * Draw below a bound and check that every result is in range and falls uniformly into buckets
+ * @param bound
+ * @param buckets the number of buckets
+ * @param bucket the bucket of a result
+ * @param what a description of the buckets
+ */
+template<class F>
+static void below(uint64_t bound, size_t buckets, F bucket, const std::string& what) {
+	const size_t        draws = 1'000'000;
+	std::vector<size_t> counts(buckets, 0);
+	rng                 random(bound);
+	bool                inside = true;
+	for (size_t k = 0; k < draws; ++k) {
+		const auto value = random.below(bound);
+		inside           = inside && value < bound;
+		++counts[bucket(value)];
+	}
+	check(inside, "below(" + std::to_string(bound) + ") is out of range");
+	const auto z = uniformity(counts, draws);
+	check(z < 4, "below(" + std::to_string(bound) + ") is biased in " + what + ", z = " +
+	                 std::to_string(z));
+}
+
+int main() {
+	// A bound of 1 has a single result, a bound of 2^64 - 1 every result but one
+	rng random(1);
+	for (int k = 0; k < 1000; ++k) check(random.below(1) == 0, "below(1) is not 0");
+	for (int k = 0; k < 1000; ++k) check(random.below(UINT64_MAX) < UINT64_MAX, "below(max)");
+
+	below(10, 10, [](uint64_t v) { return v; }, "its values");
+	below(1000, 1000, [](uint64_t v) { return v; }, "its values");
+	below((uint64_t{ 1 } << 32) + 1, 16, [](uint64_t v) { return v % 16; }, "its residues");
+
+	// A bound of 3 * 2^62 is where a modulo is most biased towards the low quarter, and a multiply
+	// without rejection towards the multiples of 3
+	constexpr uint64_t bound = uint64_t{ 3 } << 62;
+	below(bound, 3, [](uint64_t v) { return v >> 62; }, "its quarters");
+	below(bound, 3, [](uint64_t v) { return v % 3; }, "its residues");
+
+	// Jumping is deterministic, and the streams split off one generator do not overlap in their
+	// first draws
+	const size_t          window = 100'000;
+	rng                   streams(42);
+	std::vector<uint64_t> drawn;
+	std::vector<rng>      split;
+	for (int s = 0; s < 4; ++s) split.push_back(streams.split());
+	rng jumped(42);
+	jumped.jump();
+	check(split[1]() == jumped(), "split does not jump by the same distance as jump");
+	for (auto& stream : split)
+		for (size_t k = 0; k < window; ++k) drawn.push_back(stream());
+	std::sort(drawn.begin(), drawn.end());
+	check(std::adjacent_find(drawn.begin(), drawn.end()) == drawn.end(),
+	      "split streams repeat a draw");
+
+	// The same seed gives the same stream
+	rng once(42), again(42);
+	for (size_t k = 0; k < window; ++k) check(once() == again(), "a seed does not repeat");
+
+	return exit_status();
+}
@@ -0,0 +1,49 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "check.h"
+#include "instances.h"
+#include "rng.h"
+#include "solution.h"
+#include "solver.h"
+#include "threads.h"
+
+#include <sstream>
+#include <thread>
+
+int main() {
+	const problem* p = random_instance(50, 5).build();
+
+	// Outside a solve the local search runs on the calling thread alone
+	check(threads().size() == 1, "there is a pool outside a solve");
+	std::thread([] { check(threads().size() == 1, "a new thread has a pool"); }).join();
+
+	// A solve that throws restores the output style, the diagnostics and the random stream of the
+	// calling thread
+	std::ostringstream log;
+	generator()      = rng(5);
+	const rng before = generator();
+	options   o;
+	o.CH          = greedy_ch{};
+	o.verbose     = true;
+	o.log         = &log;
+	o.threads     = 2;
+	o.seed        = 9;
+	o.on_progress = [](const progress&) {
+		check(verbose && diagnostics, "the solve does not set the output style");
+		throw 1;
+	};
+	bool thrown = false;
+	try {
+		solve(*p, o);
+	} catch (int) { thrown = true; }
+	check(thrown, "the progress callback is not called");
+	check(!verbose && !diagnostics, "a throwing solve leaves its output style behind");
+	rng expected = before;
+	check(generator()() == expected(), "a throwing solve leaves its random stream behind");
+	check(threads().size() == 1, "a throwing solve leaves its pool behind");
+
+	delete p;
+	return exit_status();
+}
@@ -0,0 +1,250 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "budget.h"
+#include "check.h"
+#include "engine.h"
+#include "instances.h"
+#include "mkpproblem.h"
+#include "rng.h"
+#include "solution.h"
+#include "tabu.h"
+
+#include <algorithm>
+#include <climits>
+#include <optional>
+#include <string>
+
+/**
+ * The private state of tabu_state and Solution the test checks
+ */
+struct kernel_access {
+	/**
+	 * Recompute the value, the hash and the resources of a solution from its items
+	 * @return whether they match the kept ones and the solution is feasible
+	 */
+	template<size_t W> static bool valid(const Solution<W>& s, const problem& p) {
+		unsigned int value   = 0;
+		uint64_t     zobrist = 0;
+		Vector<long> used(static_cast<size_t>(p.m), 0);
+		for (size_t item = 0; item < s.sol.size(); ++item) {
+			if (!s.sol[item]) continue;
+			value += p.profits[item];
+			zobrist ^= p.zobrist[item];
+			for (size_t i = 0; i < used.size(); ++i) used[i] += p.constraints[item][i];
+		}
+
+		bool valid = value == s.profit() && zobrist == s.zobrist;
+		for (size_t i = 0; i < used.size(); ++i)
+			valid = valid && used[i] == s.resources_used[i] && used[i] <= p.capacities[i];
+		return valid;
+	}
+
+	/**
+	 * Check the slack, the ordered items and the blocking knapsacks of a tabu state against a full
+	 * recompute from its solution
+	 * @return whether the incremental state is consistent
+	 */
+	template<size_t W> static bool consistent(const tabu_state<W>& state, const problem& p) {
+		const auto& s = state.current;
+		if (!valid(s, p)) return false;
+
+		for (size_t i = 0; i < state.width; ++i)
+			if (state.slack[i] != p.capacities[i] - s.resources_used[i]) return false;
+
+		// The items in the solution by increasing profit, the others by decreasing profit, every
+		// item in exactly one of them
+		const size_t n = s.sol.size();
+		if (state.in.size() + state.out.size() != n) return false;
+		Vector<bool> seen(n, false);
+		for (size_t k = 0; k < state.in.size(); ++k) {
+			const auto item = state.in[k];
+			if (!s.sol[item] || seen[item]) return false;
+			if (k > 0 && state.rank[state.in[k - 1]] < state.rank[item]) return false;
+			seen[item] = true;
+		}
+		for (size_t k = 0; k < state.out.size(); ++k) {
+			const auto item = state.out[k];
+			if (s.sol[item] || seen[item]) return false;
+			if (k > 0 && state.rank[state.out[k - 1]] > state.rank[item]) return false;
+			seen[item] = true;
+		}
+
+		// An item blocked by a knapsack is too heavy for it, an item that is not fits on its own
+		for (auto item : state.out) {
+			const int*   weights = p.constraints[item];
+			const size_t blocker = state.blocker[item];
+			if (blocker > state.m) return false;
+			if (blocker < state.m && weights[blocker] <= state.slack[blocker]) return false;
+			if (blocker == state.m)
+				for (size_t i = 0; i < state.m; ++i)
+					if (weights[i] > state.slack[i]) return false;
+		}
+		return true;
+	}
+
+	template<size_t W>
+	static bool tabu(const tabu_state<W>& state, size_t item, uint64_t iteration) {
+		return state.tabu[item] > iteration;
+	}
+
+	template<size_t W> static uint64_t until(const tabu_state<W>& state, size_t item) {
+		return state.tabu[item];
+	}
+};
+
+/**
+ * The value change of the best admissible move, by trying every add, drop, 1-1 swap and 2-1 swap
+ * against the resources recomputed from the items
+ * @return LONG_MIN when no move is admissible
+ */
+template<size_t W>
+static long best_move(const tabu_state<W>& state, const problem& p, uint64_t iteration,
+                      long record) {
+	const auto&  s = state.solution();
+	const size_t n = s.items().size(), m = static_cast<size_t>(p.m);
+	Vector<long> slack(m);
+	for (size_t i = 0; i < m; ++i) {
+		slack[i] = p.capacities[i];
+		for (size_t item = 0; item < n; ++item)
+			if (s.items()[item]) slack[i] -= p.constraints[item][i];
+	}
+
+	Vector<size_t> in, out;
+	for (size_t item = 0; item < n; ++item) (s.items()[item] ? in : out).push_back(item);
+	const auto tabu = [&](size_t item) { return kernel_access::tabu(state, item, iteration); };
+
+	long best = LONG_MIN;
+	// A move drops the items of dropped and adds added, if any
+	const auto consider = [&](std::initializer_list<size_t> dropped, std::optional<size_t> added) {
+		long delta     = 0;
+		bool forbidden = false;
+		for (auto j : dropped) {
+			delta -= p.profits[j];
+			forbidden = forbidden || tabu(j);
+		}
+		if (added) {
+			delta += p.profits[*added];
+			forbidden = forbidden || tabu(*added);
+			for (size_t i = 0; i < m; ++i) {
+				long room = slack[i];
+				for (auto j : dropped) room += p.constraints[j][i];
+				if (p.constraints[*added][i] > room) return;
+			}
+		}
+		if (forbidden && static_cast<long>(s.profit()) + delta <= record) return;
+		best = std::max(best, delta);
+	};
+
+	for (auto k : out) consider({}, k);
+	for (auto j : in) consider({ j }, std::nullopt);
+	for (auto j : in)
+		for (auto k : out) consider({ j }, k);
+	for (size_t a = 0; a < in.size(); ++a)
+		for (size_t c = a + 1; c < in.size(); ++c)
+			for (auto k : out) consider({ in[a], in[c] }, k);
+	return best;
+}
+
+/**
+ * Run the moves of a tabu search step by step: every chosen move must be the best admissible one,
+ * a tabu move must reach a new best value, the flipped items must become tabu for [tenure,
+ * 2 * tenure) iterations and the incremental state must match a full recompute after every move
+ * and after every return to the best solution
+ * @param p
+ * @param tenure
+ * @param steps
+ * @param aspirations incremented by the number of aspirated moves
+ */
+template<size_t W>
+static void moves(const problem& p, size_t tenure, size_t steps, size_t& aspirations) {
+	const auto name = std::to_string(p.n) + "x" + std::to_string(p.m) + ", tenure " +
+	                  std::to_string(tenure) + ": ";
+	generator() = rng(static_cast<uint64_t>(p.m));
+
+	tabu_state<W> state(p, Solution<W>(p, toyoda_ch{}), tenure);
+	Solution<W>   best = state.solution();
+	check(kernel_access::consistent(state, p), name + "the initial state is inconsistent");
+
+	bool best_chosen = true, admissible = true, tenured = true, consistent = true;
+	for (uint64_t iteration = 1; iteration <= steps; ++iteration) {
+		const auto record   = static_cast<long>(best.profit());
+		const long expected = best_move(state, p, iteration, record);
+		uint64_t   scored   = 0;
+		const auto chosen   = state.choose(iteration, record, scored);
+		best_chosen         = best_chosen && chosen.delta == expected;
+		if (chosen.delta == LONG_MIN) {
+			state.forget();
+			continue;
+		}
+
+		// A move is tabu exactly when it flips a tabu item, and then only taken for a new best
+		bool forbidden = chosen.added && kernel_access::tabu(state, *chosen.added, iteration);
+		for (size_t d = 0; d < chosen.drops; ++d)
+			forbidden = forbidden || kernel_access::tabu(state, chosen.dropped[d], iteration);
+		const long value = static_cast<long>(state.solution().profit());
+		admissible = admissible && forbidden == chosen.aspirated &&
+		             (!chosen.aspirated || value + chosen.delta > record);
+		aspirations += chosen.aspirated;
+
+		state.apply(chosen, iteration);
+		const auto tenure_of = [&](size_t item) {
+			const auto until = kernel_access::until(state, item);
+			return until >= iteration + tenure && until < iteration + 2 * tenure;
+		};
+		if (chosen.added) tenured = tenured && tenure_of(*chosen.added);
+		for (size_t d = 0; d < chosen.drops; ++d) tenured = tenured && tenure_of(chosen.dropped[d]);
+		consistent = consistent && state.solution().profit() == value + chosen.delta &&
+		             kernel_access::consistent(state, p);
+
+		if (state.solution() > best) best = state.solution();
+		if (iteration % 25 == 0) {
+			state.reset(best);
+			consistent = consistent && kernel_access::consistent(state, p) &&
+			             state.solution().profit() == best.profit();
+		}
+	}
+
+	check(best_chosen, name + "a move is not the best admissible one");
+	check(admissible, name + "a tabu move is taken without reaching a new best value");
+	check(tenured, name + "a flipped item is not tabu for [tenure, 2 * tenure) iterations");
+	check(consistent, name + "the slack, the ordered items or the blocking knapsacks are stale");
+}
+
+/**
+ * Every solution tabu_search returns is feasible and consistent, and not worse than Toyoda
+ * @param p
+ */
+template<size_t W> static void solutions(const problem& p) {
+	const auto name = std::to_string(p.n) + "x" + std::to_string(p.m) + ": ";
+	for (size_t tenure : { 1, 3, 10 }) {
+		generator() = rng(tenure);
+		budget::limits limits;
+		limits.iterations = 2000;
+		budget            b(limits);
+		const auto        s = tabu_search<W>(p, tabu_search_sla{ tenure }, b);
+		s.validate(p);
+		check(!s.invalid(p) && kernel_access::valid(s, p),
+		      name + "tabu search returns an invalid solution, tenure " + std::to_string(tenure));
+		check(s.profit() >= Solution<W>(p, toyoda_ch{}).profit(),
+		      name + "tabu search returns a solution worse than its start");
+	}
+}
+
+int main() {
+	size_t aspirations = 0;
+	// The widths of 5 and 30 knapsacks are specialised, 40 is dynamic
+	for (size_t m : { 5, 30, 40 }) {
+		const problem* p = random_instance(40, m).build();
+		with_width(*p, [&](auto width) {
+			constexpr size_t W = decltype(width)::value;
+			for (size_t tenure : { 1, 3, 10 }) moves<W>(*p, tenure, 300, aspirations);
+			solutions<W>(*p);
+		});
+		delete p;
+	}
+	check(aspirations > 0, "no tabu move was ever aspirated");
+
+	return exit_status();
+}
@@ -0,0 +1,142 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "check.h"
+#include "engine.h"
+#include "instances.h"
+#include "mkpproblem.h"
+#include "rng.h"
+#include "solution.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <numeric>
+#include <vector>
+
+/**
+ * The private state of Solution the test compares
+ */
+struct kernel_access {
+	template<size_t W> static bool add(Solution<W>& s, size_t item, const problem& p) {
+		return s.add(item, p);
+	}
+
+	template<size_t W> static void toyoda(Solution<W>& s, const problem& p) { s.toyoda(p); }
+
+	// The selected items in insertion order as long as no item was removed
+	template<size_t W> static const Vector<unsigned int>& selected(const Solution<W>& s) {
+		return s.selected;
+	}
+};
+
+/**
+ * The original Toyoda: recompute U and the pseudo-utility of every item after every insertion,
+ * sort all items and insert the first one that fits. Ties are broken by the lowest item index.
+ * @param p
+ * @param start the items selected before the completion
+ * @return the inserted items in insertion order
+ */
+static std::vector<size_t> reference_toyoda(const problem& p, const std::vector<size_t>& start) {
+	const auto n = static_cast<size_t>(p.n);
+	const auto m = static_cast<size_t>(p.m);
+
+	std::vector<char> selected(n, 0);
+	std::vector<long> used(m, 0);
+	const auto        insert = [&](size_t item) {
+		selected[item] = 1;
+		for (size_t i = 0; i < m; ++i) used[i] += p.constraints[item][i];
+	};
+	for (auto item : start) insert(item);
+
+	std::vector<size_t> inserted;
+	for (;;) {
+		std::vector<double> U(m, 0.0);
+		for (size_t item = 0; item < n; ++item)
+			if (selected[item])
+				for (size_t i = 0; i < m; ++i) U[i] += p.A[item][i];
+		if (std::all_of(U.begin(), U.end(), [](double u) { return u == 0.0; }))
+			std::fill(U.begin(), U.end(), 1.0);
+
+		std::vector<double> utility(n);
+		for (size_t item = 0; item < n; ++item) {
+			double v = 0;
+			for (size_t i = 0; i < m; ++i) v += p.A[item][i] * U[i];
+			utility[item] = static_cast<double>(p.profits[item]) / v;
+		}
+
+		std::vector<size_t> order(n);
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(),
+		                 [&](size_t a, size_t b) { return utility[a] > utility[b]; });
+
+		const auto fits = [&](size_t item) {
+			if (selected[item]) return false;
+			for (size_t i = 0; i < m; ++i)
+				if (used[i] + p.constraints[item][i] > p.capacities[i]) return false;
+			return true;
+		};
+		auto next = std::find_if(order.begin(), order.end(), fits);
+		if (next == order.end()) return inserted;
+
+		insert(*next);
+		inserted.push_back(*next);
+	}
+}
+
+/**
+ * Compare the insertion sequence of Solution::toyoda with the original Toyoda, from an empty
+ * solution and from partial solutions like the ones the neighbourhoods complete
+ * @param p
+ * @param name
+ * @param partials the number of random partial solutions
+ */
+static void compare(const problem& p, const std::string& name, size_t partials) {
+	with_width(p, [&](auto width) {
+		constexpr size_t W = decltype(width)::value;
+
+		for (size_t run = 0; run <= partials; ++run) {
+			// Start from a random subset of a Toyoda solution, empty in the first run
+			std::vector<size_t> start;
+			if (run > 0) {
+				Solution<W> full(p);
+				kernel_access::toyoda(full, p);
+				for (auto item : kernel_access::selected(full))
+					if (generator().below(2)) start.push_back(item);
+			}
+
+			Solution<W> s(p);
+			for (auto item : start) kernel_access::add(s, item, p);
+			kernel_access::toyoda(s, p);
+
+			const auto& selected = kernel_access::selected(s);
+			std::vector<size_t> inserted(selected.begin() + static_cast<long>(start.size()),
+			                             selected.end());
+			check(inserted == reference_toyoda(p, start),
+			      name + ": insertion sequence differs from the original Toyoda from " +
+			          std::to_string(start.size()) + " selected items");
+		}
+	});
+}
+
+int main() {
+	generator() = rng(0);
+
+	const std::filesystem::path bundled = "mkp_instances/instances";
+	check(std::filesystem::exists(bundled), "the test runs from the source directory");
+	if (std::filesystem::exists(bundled))
+		for (const auto& entry : std::filesystem::directory_iterator(bundled)) {
+			if (entry.path().extension() != ".dat") continue;
+			auto file = entry.path().string();
+			compare(*read_problem(file.data()), entry.path().filename().string(), 10);
+		}
+
+	// Widths the bundled instances do not cover
+	for (auto [n, m] : { std::pair{ 200, 5 }, { 200, 30 }, { 100, 40 } }) {
+		const problem* p = random_instance(n, m).build();
+		compare(*p, "random " + std::to_string(n) + "x" + std::to_string(m), 10);
+		delete p;
+	}
+
+	return exit_status();
+}
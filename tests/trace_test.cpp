@@ -0,0 +1,123 @@
+//
+// Created by ward on 10/18/26.
+//
+
+#include "check.h"
+#include "mpsc_queue.h"
+#include "trace.h"
+
+#include <atomic>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+
+/**
+ * A pushed element: the producer and its sequence number
+ */
+struct element {
+	size_t producer;
+	size_t k;
+};
+
+/**
+ * Several producers push while the consumer pops: every element arrives exactly once and the
+ * elements of every producer arrive in the order it pushed them
+ */
+static void queue() {
+	const size_t        producers = 4, count = 20'000;
+	mpsc_queue<element> q(64);
+
+	std::atomic<bool>        go = false;
+	std::vector<std::thread> threads;
+	for (size_t producer = 0; producer < producers; ++producer)
+		threads.emplace_back([&, producer] {
+			while (!go) std::this_thread::yield();
+			for (size_t k = 0; k < count; ++k)
+				while (!q.try_push({ producer, k })) std::this_thread::yield();
+		});
+	go = true;
+
+	std::vector<size_t> next(producers, 0);
+	bool                ordered = true;
+	for (size_t popped = 0; popped < producers * count;) {
+		auto e = q.try_pop();
+		if (!e) {
+			std::this_thread::yield();
+			continue;
+		}
+		ordered = ordered && e->producer < producers && e->k == next[e->producer];
+		if (e->producer < producers) ++next[e->producer];
+		++popped;
+	}
+	for (auto& t : threads) t.join();
+	check(ordered, "the elements of a producer arrive out of order");
+	check(!q.try_pop(), "the queue has more elements than were pushed");
+
+	// A full queue rejects a push until the consumer pops
+	mpsc_queue<element> full(4);
+	for (size_t k = 0; k < 4; ++k)
+		check(full.try_push({ 0, k }), "a push below the capacity fails");
+	check(!full.try_push({ 0, 4 }), "a full queue accepts a push");
+	check(full.try_pop()->k == 0 && full.try_push({ 0, 4 }), "a pop does not free a cell");
+}
+
+/**
+ * Several threads push improvements to a trace with a slow callback: the trace delivers
+ * increasing values only, and everything queued plus the final value when it finishes
+ */
+static void improvements() {
+	const unsigned int     producers = 4, count = 2000;
+	std::vector<incumbent> delivered;
+	const auto             slow = [&](const incumbent& update) {
+		delivered.push_back(update);
+		std::this_thread::sleep_for(microseconds(50));
+	};
+	trace tr(slow, 2 * producers * count);
+
+	// Every thread takes the next value of a shared counter, so the values reach the trace in
+	// nearly increasing order
+	std::atomic<unsigned int> counter = 0;
+	std::vector<std::thread>  threads;
+	for (unsigned int producer = 0; producer < producers; ++producer)
+		threads.emplace_back([&] {
+			for (unsigned int k = 0; k < count; ++k) {
+				const auto value = ++counter;
+				tr.push({ value, milliseconds(value), value, value });
+			}
+		});
+	for (auto& t : threads) t.join();
+	tr.finish({ producers * count, milliseconds(producers * count), 0, 0 });
+
+	bool increasing = !delivered.empty();
+	for (size_t k = 1; k < delivered.size(); ++k)
+		increasing = increasing && delivered[k].value > delivered[k - 1].value;
+	check(increasing, "the trace delivers values out of order");
+	check(!delivered.empty() && delivered.back().value == producers * count,
+	      "the trace does not deliver the final value");
+	check(!delivered.empty() && delivered.back().gap == 50, "the gap is not relative to the best");
+
+	// Values queued right before the writer stops are still delivered, all of them
+	std::vector<unsigned int> last;
+	bool                      unknown = true;
+	const auto                record  = [&](const incumbent& update) {
+		last.push_back(update.value);
+		unknown = unknown && std::isnan(update.gap);
+	};
+	trace quick(record, 0);
+	for (unsigned int value = 1; value <= 100; ++value)
+		quick.push({ value, milliseconds(0), 0, 0 });
+	quick.finish({ 100, milliseconds(0), 0, 0 });
+	bool all = last.size() == 100;
+	for (size_t k = 0; all && k < last.size(); ++k) all = last[k] == k + 1;
+	check(all, "the trace drops values queued before it finishes");
+	check(unknown, "the gap to an unknown best value is a number");
+}
+
+int main() {
+	queue();
+	improvements();
+	return exit_status();
+}